@@ -0,0 +1,199 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Двунаправленный A*. Каждой вершине сопоставлена точка пространства так, что
+// евклидово расстояние между точками двух вершин не превосходит веса любого пути
+// между ними. Это расстояние служит нижней оценкой остатка пути в обоих направлениях.
+// Поиски идут со средними потенциалами pf(v) = (h(v, to) - h(from, v)) / 2,
+// при которых приведённые веса рёбер неотрицательны в обоих направлениях
+template <typename Weight>
+class AStarRouter {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+    using Traits = WeightTraits<Weight>;
+
+public:
+    struct Point {
+        double x = 0;
+        double y = 0;
+        double z = 0;
+    };
+
+    AStarRouter(const Graph& graph, std::vector<Point> vertex_points);
+
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+private:
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    static constexpr Weight ZERO_WEIGHT{};
+
+    struct Label {
+        std::optional<Weight> weight;
+        EdgeId prev_edge = NO_EDGE;
+        bool settled = false;
+    };
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    Weight ComputeLowerBound(VertexId from, VertexId to) const;
+
+    const Graph& graph_;
+    std::vector<Point> vertex_points_;
+    // Входящие рёбра вершин для обратного поиска: рёбра вершины v лежат
+    // в incoming_edges_ на отрезке [incoming_offsets_[v], incoming_offsets_[v + 1])
+    std::vector<size_t> incoming_offsets_;
+    std::vector<EdgeId> incoming_edges_;
+};
+
+template <typename Weight>
+AStarRouter<Weight>::AStarRouter(const Graph& graph, std::vector<Point> vertex_points)
+    : graph_(graph)
+    , vertex_points_(std::move(vertex_points))
+{
+    const size_t vertex_count = graph.GetVertexCount();
+    if (vertex_points_.size() != vertex_count) {
+        throw std::invalid_argument("Every vertex should have a point");
+    }
+
+    const size_t edge_count = graph.GetEdgeCount();
+    incoming_offsets_.assign(vertex_count + 1, 0);
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        ++incoming_offsets_[edge.to + 1];
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        incoming_offsets_[vertex + 1] += incoming_offsets_[vertex];
+    }
+    incoming_edges_.resize(edge_count);
+    std::vector<size_t> positions(incoming_offsets_.begin(), incoming_offsets_.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        incoming_edges_[positions[graph.GetEdge(edge_id).to]++] = edge_id;
+    }
+}
+
+template <typename Weight>
+Weight AStarRouter<Weight>::ComputeLowerBound(VertexId from, VertexId to) const {
+    const Point& lhs = vertex_points_[from];
+    const Point& rhs = vertex_points_[to];
+    const double dx = lhs.x - rhs.x;
+    const double dy = lhs.y - rhs.y;
+    const double dz = lhs.z - rhs.z;
+    return Traits::FromRep(std::sqrt(dx * dx + dy * dy + dz * dz));
+}
+
+template <typename Weight>
+std::optional<typename AStarRouter<Weight>::RouteInfo>
+AStarRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (from == to) {
+        return RouteInfo{ZERO_WEIGHT, {}};
+    }
+
+    auto compute_potential = [this, from, to](VertexId vertex) {
+        return (ComputeLowerBound(vertex, to) - ComputeLowerBound(from, vertex)) / 2;
+    };
+
+    std::vector<Label> forward_labels(vertex_count);
+    std::vector<Label> backward_labels(vertex_count);
+    Queue forward_queue;
+    Queue backward_queue;
+    forward_labels[from].weight = ZERO_WEIGHT;
+    forward_queue.push({compute_potential(from), from});
+    backward_labels[to].weight = ZERO_WEIGHT;
+    backward_queue.push({-compute_potential(to), to});
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+
+    // Ключи очередей - вес плюс потенциал своего направления. Сумма ключей вершин
+    // одного пути равна его весу, поэтому лучший вес best_weight уже не улучшится,
+    // когда сумма минимальных ключей его достигнет
+    while (!forward_queue.empty() && !backward_queue.empty()) {
+        if (best_weight && !(forward_queue.top().first + backward_queue.top().first < *best_weight)) {
+            break;
+        }
+
+        const bool forward = forward_queue.top().first <= backward_queue.top().first;
+        Queue& queue = forward ? forward_queue : backward_queue;
+        std::vector<Label>& labels = forward ? forward_labels : backward_labels;
+        const std::vector<Label>& other_labels = forward ? backward_labels : forward_labels;
+
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+        if (labels[vertex].settled) {
+            continue;
+        }
+        labels[vertex].settled = true;
+        const Weight vertex_weight = *labels[vertex].weight;
+
+        auto relax = [&](EdgeId edge_id, VertexId next) {
+            const Weight candidate_weight = vertex_weight + graph_.GetEdge(edge_id).weight;
+            Label& label = labels[next];
+            if (label.weight && !(candidate_weight < *label.weight)) {
+                return;
+            }
+            label.weight = candidate_weight;
+            label.prev_edge = edge_id;
+            const Weight potential = compute_potential(next);
+            queue.push({candidate_weight + (forward ? potential : -potential), next});
+
+            if (other_labels[next].weight) {
+                const Weight route_weight = candidate_weight + *other_labels[next].weight;
+                if (!best_weight || route_weight < *best_weight) {
+                    best_weight = route_weight;
+                    meeting_vertex = next;
+                }
+            }
+        };
+
+        if (forward) {
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                relax(edge_id, graph_.GetEdge(edge_id).to);
+            }
+        } else {
+            for (size_t i = incoming_offsets_[vertex]; i < incoming_offsets_[vertex + 1]; ++i) {
+                relax(incoming_edges_[i], graph_.GetEdge(incoming_edges_[i]).from);
+            }
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = forward_labels[meeting_vertex].prev_edge; edge_id != NO_EDGE;
+         edge_id = forward_labels[graph_.GetEdge(edge_id).from].prev_edge) {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    for (EdgeId edge_id = backward_labels[meeting_vertex].prev_edge; edge_id != NO_EDGE;
+         edge_id = backward_labels[graph_.GetEdge(edge_id).to].prev_edge) {
+        edges.push_back(edge_id);
+    }
+    return RouteInfo{*best_weight, std::move(edges)};
+}
+
+}  // namespace graph
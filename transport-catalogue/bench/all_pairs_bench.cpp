@@ -0,0 +1,81 @@
+// Масштабирование предподсчёта graph::Router по числу потоков на случайном графе.
+// Сборка из каталога transport-catalogue:
+//   g++ -std=c++17 -O2 -pthread -I. bench/all_pairs_bench.cpp min_plus.cpp -o all_pairs_bench
+// Запуск: all_pairs_bench [vertex_count [max_threads]]
+// Таблица каждого многопоточного построения сверяется с однопоточной
+
+#include "router.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Graph = graph::DirectedWeightedGraph<double>;
+
+Graph MakeRandomGraph(size_t vertex_count, size_t edges_per_vertex) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<size_t> vertex_distribution(0, vertex_count - 1);
+    std::uniform_real_distribution<double> weight_distribution(1.0, 100.0);
+    Graph graph(vertex_count);
+    for (graph::VertexId from = 0; from < vertex_count; ++from) {
+        for (size_t i = 0; i < edges_per_vertex; ++i) {
+            graph.AddEdge({from, vertex_distribution(generator), weight_distribution(generator)});
+        }
+    }
+    graph.Freeze();
+    return graph;
+}
+
+struct Table {
+    std::vector<double> weights;
+    std::vector<uint32_t> prev_edges;
+};
+
+Table CopyTable(const graph::Router<double>& router, size_t vertex_count) {
+    const size_t size = vertex_count * vertex_count;
+    const auto table = router.GetRoutesTable();
+    return {{table.weights, table.weights + size}, {table.prev_edges, table.prev_edges + size}};
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t vertex_count = argc > 1 ? std::stoul(argv[1]) : 1500;
+    const size_t max_threads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    const Graph graph = MakeRandomGraph(vertex_count, 4);
+
+    std::cout << "vertices: " << vertex_count << ", edges: " << graph.GetEdgeCount()
+              << ", kernel: " << graph::min_plus::GetKernelName() << std::endl;
+
+    std::vector<size_t> thread_counts;
+    for (size_t thread_count = 1; thread_count < max_threads; thread_count *= 2) {
+        thread_counts.push_back(thread_count);
+    }
+    thread_counts.push_back(max_threads);
+
+    Table single_thread_table;
+    double single_thread_ms = 0;
+    for (const size_t thread_count : thread_counts) {
+        const auto start = std::chrono::steady_clock::now();
+        const graph::Router<double> router(graph, thread_count);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        Table table = CopyTable(router, vertex_count);
+        if (thread_count == 1) {
+            single_thread_table = std::move(table);
+            single_thread_ms = ms;
+        } else if (table.weights != single_thread_table.weights || table.prev_edges != single_thread_table.prev_edges) {
+            std::cerr << "Table built on " << thread_count << " threads differs from the single-threaded one" << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "threads: " << thread_count << ", build: " << ms << " ms, speedup: "
+                  << single_thread_ms / ms << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
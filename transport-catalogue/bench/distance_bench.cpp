@@ -0,0 +1,115 @@
+// TransportCatalogue::GetDistance до и после Freeze на синтетической сети.
+// Сборка из каталога transport-catalogue:
+//   g++ -std=c++17 -O2 -pthread -I. bench/distance_bench.cpp $(ls *.cpp | grep -v '^main.cpp$')
+//       -o distance_bench
+// Запуск: distance_bench [stop_count [query_count [runs]]]
+// Сеть и запросы строятся с фиксированным зерном; печатается медиана времени запроса
+// по runs прогонам. Ответы после Freeze сверяются с ответами до него
+
+#include "transport_catalogue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Query = std::pair<const tc::Stop*, const tc::Stop*>;
+
+// Остановка задаёт расстояния до следующей по цепочке и до нескольких случайных.
+// Обратных расстояний нет, поэтому половина запросов идёт в обратную сторону
+// и проверяет подстановку обратного расстояния
+std::vector<Query> FillNetwork(tc::TransportCatalogue& catalogue, size_t stop_count, size_t query_count) {
+    for (size_t i = 0; i < stop_count; ++i) {
+        catalogue.AddStop(tc::Stop("Stop " + std::to_string(i), {55.0 + i * 1e-5, 37.0}));
+    }
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<tc::StopId> stop_distribution(0, static_cast<tc::StopId>(stop_count - 1));
+    std::uniform_int_distribution<int> distance_distribution(100, 5000);
+    std::vector<std::pair<tc::StopId, tc::StopId>> pairs;
+    for (tc::StopId from = 0; from < stop_count; ++from) {
+        std::vector<tc::StopId> neighbours = {static_cast<tc::StopId>((from + 1) % stop_count)};
+        for (size_t i = 0; i < 3; ++i) {
+            neighbours.push_back(stop_distribution(generator));
+        }
+        for (const tc::StopId to : neighbours) {
+            catalogue.SetDistance(catalogue.GetStopById(from), catalogue.GetStopById(to),
+                                  distance_distribution(generator));
+            pairs.emplace_back(from, to);
+        }
+    }
+
+    std::vector<Query> queries;
+    queries.reserve(query_count);
+    std::uniform_int_distribution<size_t> pair_distribution(0, pairs.size() - 1);
+    for (size_t i = 0; i < query_count; ++i) {
+        auto [from, to] = pairs[pair_distribution(generator)];
+        if (i % 2 == 1) {
+            std::swap(from, to);
+        }
+        queries.emplace_back(catalogue.GetStopById(from), catalogue.GetStopById(to));
+    }
+    return queries;
+}
+
+struct RunResult {
+    double nanoseconds_per_query;
+    std::vector<int> distances;
+};
+
+RunResult Measure(const tc::TransportCatalogue& catalogue, const std::vector<Query>& queries, size_t runs) {
+    RunResult result;
+    result.distances.resize(queries.size());
+    std::vector<double> times;
+    for (size_t run = 0; run < runs; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < queries.size(); ++i) {
+            result.distances[i] = catalogue.GetDistance(queries[i].first, queries[i].second);
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        times.push_back(elapsed.count() / queries.size());
+    }
+    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    result.nanoseconds_per_query = times[times.size() / 2];
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t stop_count = argc > 1 ? std::stoul(argv[1]) : 50000;
+    const size_t query_count = argc > 2 ? std::stoul(argv[2]) : 2000000;
+    const size_t runs = argc > 3 ? std::max<size_t>(std::stoul(argv[3]), 1) : 5;
+    if (stop_count < 2 || query_count == 0) {
+        std::cerr << "Usage: distance_bench [stop_count >= 2 [query_count > 0 [runs]]]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    tc::TransportCatalogue catalogue;
+    const auto queries = FillNetwork(catalogue, stop_count, query_count);
+    std::cout << stop_count << " stops, " << catalogue.GetDistances().size() << " distances, "
+              << query_count << " queries, median of " << runs << " runs" << std::endl;
+
+    const RunResult unfrozen = Measure(catalogue, queries, runs);
+    std::cout << "unfrozen: " << unfrozen.nanoseconds_per_query << " ns/query" << std::endl;
+
+    const auto freeze_start = std::chrono::steady_clock::now();
+    catalogue.Freeze();
+    const std::chrono::duration<double, std::milli> freeze_time = std::chrono::steady_clock::now() - freeze_start;
+    std::cout << "Freeze: " << freeze_time.count() << " ms" << std::endl;
+
+    const RunResult frozen = Measure(catalogue, queries, runs);
+    std::cout << "frozen: " << frozen.nanoseconds_per_query << " ns/query, speedup "
+              << unfrozen.nanoseconds_per_query / frozen.nanoseconds_per_query << "x" << std::endl;
+
+    if (frozen.distances != unfrozen.distances) {
+        std::cerr << "Frozen distances differ from unfrozen ones" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+// TransportCatalogue::GetStop до и после Freeze: std::unordered_map против совершенной хеш-таблицы.
+// Сборка из каталога transport-catalogue:
+//   g++ -std=c++17 -O2 -pthread -I. bench/name_lookup_bench.cpp $(ls *.cpp | grep -v '^main.cpp$')
+//       -o name_lookup_bench
+// Запуск: name_lookup_bench [name_count [query_count [runs]]]
+// Названия и запросы строятся с фиксированным зерном; каждый десятый запрос - отсутствующее
+// название. Печатается медиана времени запроса по runs прогонам. Ответы после Freeze
+// сверяются с ответами до него
+
+#include "transport_catalogue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Названия вида "Street abc N" разной длины; номер N делает их различными
+std::string MakeName(std::mt19937& generator, size_t index) {
+    static const char* const PREFIXES[] = {"Street ", "Avenue ", "Boulevard ", "Square ", "Lane ", "Embankment "};
+    std::uniform_int_distribution<size_t> prefix_distribution(0, std::size(PREFIXES) - 1);
+    std::uniform_int_distribution<size_t> length_distribution(0, 12);
+    std::uniform_int_distribution<int> letter_distribution('a', 'z');
+    std::string name = PREFIXES[prefix_distribution(generator)];
+    for (size_t i = length_distribution(generator); i > 0; --i) {
+        name += static_cast<char>(letter_distribution(generator));
+    }
+    return name + ' ' + std::to_string(index);
+}
+
+struct RunResult {
+    double nanoseconds_per_query;
+    std::vector<const tc::Stop*> stops;
+};
+
+RunResult Measure(const tc::TransportCatalogue& catalogue, const std::vector<std::string>& queries, size_t runs) {
+    RunResult result;
+    result.stops.resize(queries.size());
+    std::vector<double> times;
+    for (size_t run = 0; run < runs; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < queries.size(); ++i) {
+            result.stops[i] = catalogue.GetStop(queries[i]);
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        times.push_back(elapsed.count() / queries.size());
+    }
+    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    result.nanoseconds_per_query = times[times.size() / 2];
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t name_count = argc > 1 ? std::stoul(argv[1]) : 100000;
+    const size_t query_count = argc > 2 ? std::stoul(argv[2]) : 2000000;
+    const size_t runs = argc > 3 ? std::max<size_t>(std::stoul(argv[3]), 1) : 5;
+    if (name_count == 0 || query_count == 0) {
+        std::cerr << "Usage: name_lookup_bench [name_count > 0 [query_count > 0 [runs]]]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::mt19937 generator(42);
+    tc::TransportCatalogue catalogue;
+    std::vector<std::string> names;
+    names.reserve(name_count);
+    for (size_t i = 0; i < name_count; ++i) {
+        names.push_back(MakeName(generator, i));
+        catalogue.AddStop(tc::Stop(names.back(), {55.0, 37.0}));
+    }
+
+    // Запросы - свои копии строк, чтобы сравнение с ключом не сводилось к сравнению указателей
+    std::vector<std::string> queries;
+    queries.reserve(query_count);
+    std::uniform_int_distribution<size_t> name_distribution(0, name_count - 1);
+    for (size_t i = 0; i < query_count; ++i) {
+        queries.push_back(i % 10 == 9 ? MakeName(generator, name_count + i) : names[name_distribution(generator)]);
+    }
+    std::cout << name_count << " names, " << query_count << " queries, median of " << runs << " runs" << std::endl;
+
+    const RunResult unfrozen = Measure(catalogue, queries, runs);
+    std::cout << "unfrozen: " << unfrozen.nanoseconds_per_query << " ns/query" << std::endl;
+
+    const auto freeze_start = std::chrono::steady_clock::now();
+    catalogue.Freeze();
+    const std::chrono::duration<double, std::milli> freeze_time = std::chrono::steady_clock::now() - freeze_start;
+    std::cout << "Freeze: " << freeze_time.count() << " ms" << std::endl;
+
+    const RunResult frozen = Measure(catalogue, queries, runs);
+    std::cout << "frozen: " << frozen.nanoseconds_per_query << " ns/query, speedup "
+              << unfrozen.nanoseconds_per_query / frozen.nanoseconds_per_query << "x" << std::endl;
+
+    if (frozen.stops != unfrozen.stops) {
+        std::cerr << "Frozen lookups differ from unfrozen ones" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,426 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Иерархия сжатия (contraction hierarchies): вершины сжимаются по одной в порядке
+// возрастания важности, а пути через сжатую вершину заменяются ярлыками.
+// Запрос - двунаправленный поиск Дейкстры только вверх по иерархии.
+// Ярлык помнит два ребра, которые он заменяет, поэтому маршрут раскрывается
+// обратно в последовательность исходных рёбер графа
+template <typename Weight>
+class ContractionHierarchy {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    explicit ContractionHierarchy(const Graph& graph);
+
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    size_t GetShortcutCount() const {
+        return shortcut_count_;
+    }
+
+private:
+    static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+    // Ограничение числа вершин, просматриваемых при поиске свидетеля.
+    // Если свидетель не найден за это число шагов, ярлык добавляется на всякий случай
+    static constexpr size_t WITNESS_SETTLE_LIMIT = 500;
+    static constexpr size_t SIMULATION_SETTLE_LIMIT = 50;
+    static constexpr Weight ZERO_WEIGHT{};
+
+    // Ребро иерархии: исходное ребро графа original_edge или ярлык,
+    // заменяющий рёбра иерархии first и second
+    struct HierarchyEdge {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId original_edge;
+        size_t first;
+        size_t second;
+    };
+
+    struct Neighbour {
+        VertexId vertex;
+        Weight weight;
+        size_t edge;
+    };
+
+    struct Label {
+        Weight weight;
+        size_t edge;
+    };
+    using Labels = std::unordered_map<VertexId, Label>;
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    class Contractor;
+
+    void BuildUpwardGraphs(const std::vector<size_t>& ranks);
+    void UnpackEdge(size_t edge, std::vector<EdgeId>& edges) const;
+
+    // Один шаг поиска в направлении labels. Возвращает false, если очередь пуста
+    bool SearchStep(Queue& queue, Labels& labels, const Labels& other_labels,
+                    const std::vector<size_t>& offsets, bool forward,
+                    std::optional<Weight>& best_weight, VertexId& meeting_vertex) const;
+
+    size_t vertex_count_ = 0;
+    size_t shortcut_count_ = 0;
+    std::vector<HierarchyEdge> edges_;
+    // Рёбра вверх по иерархии в формате CSR: для прямого поиска - исходящие,
+    // для обратного - входящие в вершину
+    std::vector<size_t> forward_offsets_;
+    std::vector<size_t> forward_edges_;
+    std::vector<size_t> backward_offsets_;
+    std::vector<size_t> backward_edges_;
+};
+
+template <typename Weight>
+class ContractionHierarchy<Weight>::Contractor {
+public:
+    Contractor(std::vector<HierarchyEdge>& edges, size_t vertex_count)
+        : edges_(edges)
+        , out_edges_(vertex_count)
+        , in_edges_(vertex_count)
+        , contracted_(vertex_count, false)
+        , contracted_neighbours_(vertex_count, 0)
+        , witness_weights_(vertex_count)
+    {
+        for (size_t edge = 0; edge < edges_.size(); ++edge) {
+            out_edges_[edges_[edge].from].push_back(edge);
+            in_edges_[edges_[edge].to].push_back(edge);
+        }
+    }
+
+    // Сжимает все вершины и возвращает их ранги и число добавленных ярлыков
+    std::pair<std::vector<size_t>, size_t> Run() {
+        const size_t vertex_count = contracted_.size();
+        std::priority_queue<std::pair<long long, VertexId>,
+                            std::vector<std::pair<long long, VertexId>>,
+                            std::greater<>> queue;
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            queue.push({ComputePriority(vertex), vertex});
+        }
+
+        std::vector<size_t> ranks(vertex_count);
+        size_t rank = 0;
+        size_t shortcut_count = 0;
+        while (!queue.empty()) {
+            const VertexId vertex = queue.top().second;
+            queue.pop();
+            // Приоритеты обновляются лениво: если вершина подешевела не так, как казалось,
+            // возвращаем её в очередь
+            const long long priority = ComputePriority(vertex);
+            if (!queue.empty() && priority > queue.top().first) {
+                queue.push({priority, vertex});
+                continue;
+            }
+            shortcut_count += Contract(vertex, false);
+            contracted_[vertex] = true;
+            ranks[vertex] = rank++;
+            for (const auto& neighbour : CollectNeighbours(in_edges_[vertex], false)) {
+                ++contracted_neighbours_[neighbour.vertex];
+            }
+            for (const auto& neighbour : CollectNeighbours(out_edges_[vertex], true)) {
+                ++contracted_neighbours_[neighbour.vertex];
+            }
+        }
+        return {std::move(ranks), shortcut_count};
+    }
+
+private:
+    long long ComputePriority(VertexId vertex) {
+        const long long shortcuts = static_cast<long long>(Contract(vertex, true));
+        const long long degree = static_cast<long long>(CollectNeighbours(in_edges_[vertex], false).size()
+                                                        + CollectNeighbours(out_edges_[vertex], true).size());
+        return shortcuts - degree + static_cast<long long>(contracted_neighbours_[vertex]);
+    }
+
+    // Лучшее ребро до каждого ещё не сжатого соседа
+    std::vector<Neighbour> CollectNeighbours(const std::vector<size_t>& incident_edges, bool outgoing) const {
+        std::vector<Neighbour> neighbours;
+        std::unordered_map<VertexId, size_t> positions;
+        for (const size_t edge : incident_edges) {
+            const auto& hierarchy_edge = edges_[edge];
+            const VertexId vertex = outgoing ? hierarchy_edge.to : hierarchy_edge.from;
+            if (contracted_[vertex] || hierarchy_edge.from == hierarchy_edge.to) {
+                continue;
+            }
+            const auto [it, inserted] = positions.emplace(vertex, neighbours.size());
+            if (inserted) {
+                neighbours.push_back({vertex, hierarchy_edge.weight, edge});
+            } else if (hierarchy_edge.weight < neighbours[it->second].weight) {
+                neighbours[it->second] = {vertex, hierarchy_edge.weight, edge};
+            }
+        }
+        return neighbours;
+    }
+
+    // Добавляет (или только подсчитывает при simulate) ярлыки, нужные при сжатии vertex
+    size_t Contract(VertexId vertex, bool simulate) {
+        const auto in_neighbours = CollectNeighbours(in_edges_[vertex], false);
+        const auto out_neighbours = CollectNeighbours(out_edges_[vertex], true);
+        const size_t settle_limit = simulate ? SIMULATION_SETTLE_LIMIT : WITNESS_SETTLE_LIMIT;
+
+        size_t shortcut_count = 0;
+        for (const auto& in : in_neighbours) {
+            Weight max_weight = ZERO_WEIGHT;
+            for (const auto& out : out_neighbours) {
+                max_weight = std::max(max_weight, in.weight + out.weight);
+            }
+            FindWitnesses(in.vertex, vertex, max_weight, settle_limit);
+
+            for (const auto& out : out_neighbours) {
+                if (out.vertex == in.vertex) {
+                    continue;
+                }
+                const Weight via_weight = in.weight + out.weight;
+                const auto& witness_weight = witness_weights_[out.vertex];
+                if (witness_weight && !(via_weight < *witness_weight)) {
+                    continue;
+                }
+                ++shortcut_count;
+                if (!simulate) {
+                    const size_t edge = edges_.size();
+                    edges_.push_back({in.vertex, out.vertex, via_weight, EdgeId{}, in.edge, out.edge});
+                    out_edges_[in.vertex].push_back(edge);
+                    in_edges_[out.vertex].push_back(edge);
+                }
+            }
+            ResetWitnesses();
+        }
+        return shortcut_count;
+    }
+
+    // Ограниченный поиск Дейкстры из source в обход вершины excluded
+    void FindWitnesses(VertexId source, VertexId excluded, Weight max_weight, size_t settle_limit) {
+        Queue queue;
+        witness_weights_[source] = ZERO_WEIGHT;
+        touched_.push_back(source);
+        queue.push({ZERO_WEIGHT, source});
+        size_t settled = 0;
+        while (!queue.empty() && settled < settle_limit) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (*witness_weights_[vertex] < weight) {
+                continue;
+            }
+            if (max_weight < weight) {
+                break;
+            }
+            ++settled;
+            for (const size_t edge : out_edges_[vertex]) {
+                const auto& hierarchy_edge = edges_[edge];
+                if (hierarchy_edge.to == excluded || contracted_[hierarchy_edge.to]) {
+                    continue;
+                }
+                const Weight candidate_weight = weight + hierarchy_edge.weight;
+                auto& weight_to = witness_weights_[hierarchy_edge.to];
+                if (!weight_to) {
+                    touched_.push_back(hierarchy_edge.to);
+                }
+                if (!weight_to || candidate_weight < *weight_to) {
+                    weight_to = candidate_weight;
+                    queue.push({candidate_weight, hierarchy_edge.to});
+                }
+            }
+        }
+    }
+
+    void ResetWitnesses() {
+        for (const VertexId vertex : touched_) {
+            witness_weights_[vertex].reset();
+        }
+        touched_.clear();
+    }
+
+    std::vector<HierarchyEdge>& edges_;
+    std::vector<std::vector<size_t>> out_edges_;
+    std::vector<std::vector<size_t>> in_edges_;
+    std::vector<bool> contracted_;
+    std::vector<size_t> contracted_neighbours_;
+    std::vector<std::optional<Weight>> witness_weights_;
+    std::vector<VertexId> touched_;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+    : vertex_count_(graph.GetVertexCount())
+{
+    // Из параллельных рёбер нужно только самое лёгкое, петли не нужны вовсе
+    std::unordered_map<VertexId, size_t> best_edges;
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        best_edges.clear();
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = graph.GetEdge(edge_id);
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            if (edge.to == vertex) {
+                continue;
+            }
+            const auto [it, inserted] = best_edges.emplace(edge.to, edges_.size());
+            if (inserted) {
+                edges_.push_back({vertex, edge.to, edge.weight, edge_id, NONE, NONE});
+            } else if (edge.weight < edges_[it->second].weight) {
+                edges_[it->second] = {vertex, edge.to, edge.weight, edge_id, NONE, NONE};
+            }
+        }
+    }
+
+    auto [ranks, shortcut_count] = Contractor(edges_, vertex_count_).Run();
+    shortcut_count_ = shortcut_count;
+    BuildUpwardGraphs(ranks);
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildUpwardGraphs(const std::vector<size_t>& ranks) {
+    forward_offsets_.assign(vertex_count_ + 1, 0);
+    backward_offsets_.assign(vertex_count_ + 1, 0);
+    for (const auto& edge : edges_) {
+        if (ranks[edge.from] < ranks[edge.to]) {
+            ++forward_offsets_[edge.from + 1];
+        } else {
+            ++backward_offsets_[edge.to + 1];
+        }
+    }
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        forward_offsets_[vertex + 1] += forward_offsets_[vertex];
+        backward_offsets_[vertex + 1] += backward_offsets_[vertex];
+    }
+
+    forward_edges_.resize(forward_offsets_.back());
+    backward_edges_.resize(backward_offsets_.back());
+    std::vector<size_t> forward_positions(forward_offsets_.begin(), std::prev(forward_offsets_.end()));
+    std::vector<size_t> backward_positions(backward_offsets_.begin(), std::prev(backward_offsets_.end()));
+    for (size_t edge = 0; edge < edges_.size(); ++edge) {
+        const auto& hierarchy_edge = edges_[edge];
+        if (ranks[hierarchy_edge.from] < ranks[hierarchy_edge.to]) {
+            forward_edges_[forward_positions[hierarchy_edge.from]++] = edge;
+        } else {
+            backward_edges_[backward_positions[hierarchy_edge.to]++] = edge;
+        }
+    }
+}
+
+template <typename Weight>
+bool ContractionHierarchy<Weight>::SearchStep(Queue& queue, Labels& labels, const Labels& other_labels,
+                                              const std::vector<size_t>& offsets, bool forward,
+                                              std::optional<Weight>& best_weight,
+                                              VertexId& meeting_vertex) const {
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (labels.at(vertex).weight < weight) {
+            continue;
+        }
+        if (const auto it = other_labels.find(vertex); it != other_labels.end()) {
+            const Weight route_weight = weight + it->second.weight;
+            if (!best_weight || route_weight < *best_weight) {
+                best_weight = route_weight;
+                meeting_vertex = vertex;
+            }
+        }
+
+        const auto& upward_edges = forward ? forward_edges_ : backward_edges_;
+        for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+            const size_t edge = upward_edges[i];
+            const auto& hierarchy_edge = edges_[edge];
+            const VertexId next_vertex = forward ? hierarchy_edge.to : hierarchy_edge.from;
+            const Weight candidate_weight = weight + hierarchy_edge.weight;
+            const auto [it, inserted] = labels.emplace(next_vertex, Label{candidate_weight, edge});
+            if (inserted || candidate_weight < it->second.weight) {
+                it->second = Label{candidate_weight, edge};
+                queue.push({candidate_weight, next_vertex});
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo>
+ContractionHierarchy<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    Labels forward_labels{{from, Label{ZERO_WEIGHT, NONE}}};
+    Labels backward_labels{{to, Label{ZERO_WEIGHT, NONE}}};
+    Queue forward_queue;
+    Queue backward_queue;
+    forward_queue.push({ZERO_WEIGHT, from});
+    backward_queue.push({ZERO_WEIGHT, to});
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+    // Каждое направление продолжается, пока его минимум в очереди меньше лучшего маршрута
+    auto is_active = [&best_weight](const Queue& queue) {
+        return !queue.empty() && (!best_weight || queue.top().first < *best_weight);
+    };
+    while (is_active(forward_queue) || is_active(backward_queue)) {
+        const bool forward = is_active(forward_queue)
+            && (!is_active(backward_queue) || !(backward_queue.top().first < forward_queue.top().first));
+        if (forward) {
+            SearchStep(forward_queue, forward_labels, backward_labels, forward_offsets_, true,
+                       best_weight, meeting_vertex);
+        } else {
+            SearchStep(backward_queue, backward_labels, forward_labels, backward_offsets_, false,
+                       best_weight, meeting_vertex);
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    std::vector<size_t> route_edges;
+    for (size_t edge = forward_labels.at(meeting_vertex).edge; edge != NONE;
+         edge = forward_labels.at(edges_[edge].from).edge) {
+        route_edges.push_back(edge);
+    }
+    std::reverse(route_edges.begin(), route_edges.end());
+    for (size_t edge = backward_labels.at(meeting_vertex).edge; edge != NONE;
+         edge = backward_labels.at(edges_[edge].to).edge) {
+        route_edges.push_back(edge);
+    }
+
+    std::vector<EdgeId> edges;
+    for (const size_t edge : route_edges) {
+        UnpackEdge(edge, edges);
+    }
+    return RouteInfo{*best_weight, std::move(edges)};
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackEdge(size_t edge, std::vector<EdgeId>& edges) const {
+    std::vector<size_t> stack{edge};
+    while (!stack.empty()) {
+        const auto& hierarchy_edge = edges_[stack.back()];
+        stack.pop_back();
+        if (hierarchy_edge.first == NONE) {
+            edges.push_back(hierarchy_edge.original_edge);
+        } else {
+            stack.push_back(hierarchy_edge.second);
+            stack.push_back(hierarchy_edge.first);
+        }
+    }
+}
+
+}  // namespace graph
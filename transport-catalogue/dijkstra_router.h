@@ -0,0 +1,199 @@
+#pragma once
+
+#include "graph.h"
+#include "query_context.h"
+#include "router.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Маршрутизатор без предподсчёта: каждый запрос BuildRoute
+// выполняет алгоритм Дейкстры от вершины from до вершины to.
+// Поиски идут в контексте запроса; методы без контекста берут контекст текущего потока
+template <typename Weight>
+class DijkstraRouter {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+    using Context = QueryContext<Weight>;
+
+public:
+    explicit DijkstraRouter(const Graph& graph);
+
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    // Вес маршрута, рёбра маршрута - в context.GetRouteEdges(). Память не выделяется,
+    // как только буферы контекста доросли до размеров графа и маршрута
+    std::optional<Weight> BuildRoute(VertexId from, VertexId to, Context& context) const;
+
+    // Один поиск из from до всех вершин targets в контексте. Его результаты читаются
+    // GetFoundRoute или прямо из контекста, пока в нём не начат следующий поиск
+    void Search(VertexId from, const std::vector<VertexId>& targets, Context& context) const;
+    // Вес маршрута до to, найденного Search, рёбра маршрута - в context.GetRouteEdges()
+    std::optional<Weight> GetFoundRoute(VertexId to, Context& context) const;
+
+    // Все вершины, достижимые из from с весом не больше max_weight, в порядке возрастания веса.
+    // Поиск останавливается, как только фронт превышает max_weight
+    std::vector<std::pair<VertexId, Weight>> ComputeWeightsWithin(VertexId from, Weight max_weight) const;
+
+private:
+    // Поиск останавливается, как только найдены кратчайшие пути до всех вершин targets
+    template <typename Targets>
+    void ComputeVerticesData(VertexId from, const Targets& targets, Context& context) const;
+    // Рёбра маршрута до to в порядке от from
+    void ExtractRouteEdges(const Context& context, VertexId to, std::vector<EdgeId>& edges) const;
+    std::optional<RouteInfo> ExtractRoute(const Context& context, VertexId to) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+    : graph_(graph)
+{
+    const size_t edge_count = graph.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+template <typename Targets>
+void DijkstraRouter<Weight>::ComputeVerticesData(VertexId from, const Targets& targets, Context& context) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    context.Reset(vertex_count);
+    size_t targets_left = 0;
+    for (const VertexId target : targets) {
+        if (target >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        if (!context.IsMarked(target)) {
+            context.Mark(target);
+            ++targets_left;
+        }
+    }
+
+    context.Reach(from, ZERO_WEIGHT, Context::NO_EDGE);
+    context.Push(ZERO_WEIGHT, from);
+
+    while (!context.IsQueueEmpty() && targets_left > 0) {
+        const VertexId vertex = context.Pop().second;
+        if (context.IsSettled(vertex)) {
+            continue;
+        }
+        context.Settle(vertex);
+        if (context.IsMarked(vertex)) {
+            --targets_left;
+        }
+
+        const Weight vertex_weight = context.GetWeight(vertex);
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const Weight candidate_weight = vertex_weight + edge.weight;
+            if (!context.IsReached(edge.to) || candidate_weight < context.GetWeight(edge.to)) {
+                context.Reach(edge.to, candidate_weight, edge_id);
+                context.Push(candidate_weight, edge.to);
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void DijkstraRouter<Weight>::ExtractRouteEdges(const Context& context, VertexId to, std::vector<EdgeId>& edges) const {
+    edges.clear();
+    for (EdgeId edge_id = context.GetPrevEdge(to);
+         edge_id != Context::NO_EDGE;
+         edge_id = context.GetPrevEdge(graph_.GetEdge(edge_id).from))
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo>
+DijkstraRouter<Weight>::ExtractRoute(const Context& context, VertexId to) const {
+    if (!context.IsReached(to)) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    ExtractRouteEdges(context, to, edges);
+    return RouteInfo{context.GetWeight(to), std::move(edges)};
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo>
+DijkstraRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    Context& context = Context::ForCurrentThread();
+    ComputeVerticesData(from, std::initializer_list<VertexId>{to}, context);
+    return ExtractRoute(context, to);
+}
+
+template <typename Weight>
+std::optional<Weight> DijkstraRouter<Weight>::BuildRoute(VertexId from, VertexId to, Context& context) const {
+    ComputeVerticesData(from, std::initializer_list<VertexId>{to}, context);
+    return GetFoundRoute(to, context);
+}
+
+template <typename Weight>
+void DijkstraRouter<Weight>::Search(VertexId from, const std::vector<VertexId>& targets, Context& context) const {
+    ComputeVerticesData(from, targets, context);
+}
+
+template <typename Weight>
+std::optional<Weight> DijkstraRouter<Weight>::GetFoundRoute(VertexId to, Context& context) const {
+    if (!context.IsReached(to)) {
+        return std::nullopt;
+    }
+    ExtractRouteEdges(context, to, context.GetRouteEdges());
+    return context.GetWeight(to);
+}
+
+template <typename Weight>
+std::vector<std::pair<VertexId, Weight>>
+DijkstraRouter<Weight>::ComputeWeightsWithin(VertexId from, Weight max_weight) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    Context& context = Context::ForCurrentThread();
+    context.Reset(vertex_count);
+    std::vector<std::pair<VertexId, Weight>> reachable;
+
+    context.Reach(from, ZERO_WEIGHT, Context::NO_EDGE);
+    context.Push(ZERO_WEIGHT, from);
+
+    while (!context.IsQueueEmpty()) {
+        const auto [vertex_weight, vertex] = context.Pop();
+        if (context.IsSettled(vertex)) {
+            continue;
+        }
+        context.Settle(vertex);
+        reachable.emplace_back(vertex, vertex_weight);
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const Weight candidate_weight = vertex_weight + edge.weight;
+            if (!(max_weight < candidate_weight)
+                && (!context.IsReached(edge.to) || candidate_weight < context.GetWeight(edge.to))) {
+                context.Reach(edge.to, candidate_weight, edge_id);
+                context.Push(candidate_weight, edge.to);
+            }
+        }
+    }
+    return reachable;
+}
+
+}  // namespace graph
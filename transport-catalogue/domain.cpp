@@ -4,12 +4,12 @@
 
 namespace tc{
 
-Stop::Stop(std::string name, geo::Coordinates coordinates) : 
-   name_(std::move(name)), coordinates_(coordinates) {}
+Stop::Stop(std::string_view name, geo::Coordinates coordinates) : 
+   name_(name), coordinates_(coordinates) {}
 
 
-Bus::Bus(std::string name, Route stops, bool is_circle) :
-   name_(std::move(name)), stops_(std::move(stops)), is_circle_(is_circle)
+Bus::Bus(std::string_view name, Route stops, bool is_circle) :
+   name_(name), stops_(std::move(stops)), is_circle_(is_circle)
     {}
 
 bool Bus::operator<(Bus& other) {
@@ -22,14 +22,10 @@ bool BusPtrComparator::operator()(Bus* lhs, Bus* rhs) const {
 }
 
 size_t Hasher::operator()(const Stop *stop) const  {
-    return std::hash<std::string>{}(stop->name_)
-      + std::hash<double>{}(stop->coordinates_.lat) * salt
-      + std::hash<double>{}(stop->coordinates_.lng) * salt * salt;
+    return std::hash<StopId>{}(stop->id_);
 }
 
-std::size_t Hasher::operator()(const std::pair<const Stop*, const Stop*> pair_stops) const noexcept {
-    auto hash_1 = static_cast<const void*>(pair_stops.first);
-    auto hash_2 = static_cast<const void*>(pair_stops.second);
-    return hasher(hash_1) *  salt + hasher(hash_2);
+std::size_t Hasher::operator()(const std::pair<StopId, StopId> pair_stops) const noexcept {
+    return std::hash<uint64_t>{}(static_cast<uint64_t>(pair_stops.first) << 32 | pair_stops.second);
 }
 }
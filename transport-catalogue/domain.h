@@ -2,19 +2,28 @@
 
 #include "geo.h"
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 
 namespace tc{
+
+// Номера остановок и автобусов в справочнике: идут подряд с нуля в порядке добавления
+using StopId = uint32_t;
+using BusId = uint32_t;
+
 struct Stop
 {
     Stop() = default;
 
-    Stop(std::string name, geo::Coordinates coordinates);
+    Stop(std::string_view name, geo::Coordinates coordinates);
 
-	std::string name_;
+	// Название в арене справочника; до AddStop - в строке того, кто создал остановку
+	std::string_view name_;
 	geo::Coordinates coordinates_;
+	StopId id_ = 0;  // Назначается в TransportCatalogue::AddStop
 };
 
 using Route = std::vector<Stop*>;
@@ -22,13 +31,14 @@ using Route = std::vector<Stop*>;
 struct Bus {
     Bus() = default;
 
-    Bus(std::string name_bus, Route stops, bool is_circle);
+    Bus(std::string_view name_bus, Route stops, bool is_circle);
 
     bool operator<(Bus& other) ;
 
-    std::string name_;
+    std::string_view name_;  // Как у Stop::name_
     Route stops_;
     bool is_circle_;	
+    BusId id_ = 0;  // Назначается в TransportCatalogue::AddBus
 };
 
 struct BusPtrComparator {
@@ -44,13 +54,11 @@ struct BusInfo {
     double curvature;
 };
 
+// Хеши по номерам остановок
 struct Hasher {
-    std::hash<const void*> hasher;
-    static const size_t salt = 24; 
-
     size_t operator()(const Stop *stop) const;
     
-    std::size_t operator()(const std::pair<const Stop*, const Stop*> pair_stops) const noexcept;
+    std::size_t operator()(const std::pair<StopId, StopId> pair_stops) const noexcept;
     
 };
 }
@@ -2,7 +2,13 @@
 
 #include "ranges.h"
 
+#include <cassert>
+#include <cstddef>
 #include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace graph {
@@ -17,58 +23,214 @@ struct Edge {
     Weight weight;
 };
 
+// Идентификаторы рёбер, исходящих из вершины. До заморозки графа они берутся
+// из списка смежности вершины, после - идут подряд, и итератор просто их считает
+class IncidentEdgeIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = EdgeId;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const EdgeId*;
+    using reference = EdgeId;
+
+    IncidentEdgeIterator(const EdgeId* edge_ids, size_t index)
+        : edge_ids_(edge_ids)
+        , index_(index) {
+    }
+
+    EdgeId operator*() const {
+        return edge_ids_ ? edge_ids_[index_] : index_;
+    }
+    IncidentEdgeIterator& operator++() {
+        ++index_;
+        return *this;
+    }
+    IncidentEdgeIterator operator++(int) {
+        auto copy = *this;
+        ++index_;
+        return copy;
+    }
+    bool operator==(const IncidentEdgeIterator& other) const {
+        return index_ == other.index_ && edge_ids_ == other.edge_ids_;
+    }
+    bool operator!=(const IncidentEdgeIterator& other) const {
+        return !(*this == other);
+    }
+
+private:
+    const EdgeId* edge_ids_;  // nullptr - итератор по замороженному графу
+    size_t index_;
+};
+
+// Структура графа (концы рёбер и списки смежности) хранится отдельно от весов и
+// разделяется между копиями графа: копия дублирует только веса. Поэтому на одной
+// структуре можно держать несколько наборов весов. Структура копируется при изменении,
+// если её разделяет другой граф
 template <typename Weight>
 class DirectedWeightedGraph {
 private:
     using IncidenceList = std::vector<EdgeId>;
-    using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+    using IncidentEdgesRange = ranges::Range<IncidentEdgeIterator>;
 
 public:
     DirectedWeightedGraph() = default;
     explicit DirectedWeightedGraph(size_t vertex_count);
+    // Сразу замороженный граф: рёбра упорядочены по from, offsets - как после Freeze()
+    DirectedWeightedGraph(const std::vector<Edge<Weight>>& edges, std::vector<EdgeId> offsets);
     EdgeId AddEdge(const Edge<Weight>& edge);
 
+    // Переводит граф в компактную форму (CSR): рёбра переупорядочиваются по вершине from
+    // и хранятся подряд, а списки смежности заменяются массивом смещений.
+    // Порядок рёбер одной вершины сохраняется. Возвращает новые идентификаторы
+    // рёбер по старым. После заморозки добавлять рёбра нельзя
+    std::vector<EdgeId> Freeze();
+    bool IsFrozen() const;
+
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
-    const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+    Edge<Weight> GetEdge(EdgeId edge_id) const;
+    // Меняет только вес: структура графа, в том числе замороженного, остаётся прежней
+    void SetEdgeWeight(EdgeId edge_id, Weight weight);
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
+    // Разделяют ли графы одну структуру
+    bool SharesTopologyWith(const DirectedWeightedGraph& other) const;
+
 private:
-    std::vector<Edge<Weight>> edges_;
-    std::vector<IncidenceList> incidence_lists_;
+    struct EdgeEnds {
+        VertexId from;
+        VertexId to;
+    };
+
+    struct Topology {
+        std::vector<EdgeEnds> edges;
+        std::vector<IncidenceList> incidence_lists;
+        // После заморозки рёбра вершины v - [offsets[v], offsets[v + 1])
+        std::vector<EdgeId> offsets;
+    };
+
+    Topology& GetMutableTopology();
+
+    std::shared_ptr<Topology> topology_ = std::make_shared<Topology>();
+    std::vector<Weight> weights_;
 };
 
 template <typename Weight>
-DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-    : incidence_lists_(vertex_count) {
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count) {
+    topology_->incidence_lists.resize(vertex_count);
+}
+
+template <typename Weight>
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(const std::vector<Edge<Weight>>& edges,
+                                                     std::vector<EdgeId> offsets) {
+    if (offsets.empty() || offsets.back() != edges.size()) {
+        throw std::invalid_argument("Offsets don't match edges");
+    }
+    topology_->offsets = std::move(offsets);
+    topology_->edges.reserve(edges.size());
+    weights_.reserve(edges.size());
+    for (const auto& edge : edges) {
+        topology_->edges.push_back({edge.from, edge.to});
+        weights_.push_back(edge.weight);
+    }
+}
+
+template <typename Weight>
+typename DirectedWeightedGraph<Weight>::Topology& DirectedWeightedGraph<Weight>::GetMutableTopology() {
+    if (topology_.use_count() > 1) {
+        topology_ = std::make_shared<Topology>(*topology_);
+    }
+    return *topology_;
 }
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
-    edges_.push_back(edge);
-    const EdgeId id = edges_.size() - 1;
-    incidence_lists_.at(edge.from).push_back(id);
+    if (IsFrozen()) {
+        throw std::logic_error("Can't add an edge to a frozen graph");
+    }
+    Topology& topology = GetMutableTopology();
+    topology.edges.push_back({edge.from, edge.to});
+    weights_.push_back(edge.weight);
+    const EdgeId id = weights_.size() - 1;
+    topology.incidence_lists.at(edge.from).push_back(id);
     return id;
 }
 
+template <typename Weight>
+std::vector<EdgeId> DirectedWeightedGraph<Weight>::Freeze() {
+    std::vector<EdgeId> new_ids(weights_.size());
+    if (IsFrozen()) {
+        for (EdgeId edge_id = 0; edge_id < weights_.size(); ++edge_id) {
+            new_ids[edge_id] = edge_id;
+        }
+        return new_ids;
+    }
+
+    Topology& topology = GetMutableTopology();
+    const size_t vertex_count = topology.incidence_lists.size();
+    topology.offsets.assign(vertex_count + 1, 0);
+    std::vector<EdgeEnds> edges;
+    std::vector<Weight> weights;
+    edges.reserve(weights_.size());
+    weights.reserve(weights_.size());
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        for (const EdgeId edge_id : topology.incidence_lists[vertex]) {
+            new_ids[edge_id] = edges.size();
+            edges.push_back(topology.edges[edge_id]);
+            weights.push_back(weights_[edge_id]);
+        }
+        topology.offsets[vertex + 1] = edges.size();
+    }
+
+    topology.edges = std::move(edges);
+    weights_ = std::move(weights);
+    topology.incidence_lists.clear();
+    topology.incidence_lists.shrink_to_fit();
+    return new_ids;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return !topology_->offsets.empty();
+}
+
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return IsFrozen() ? topology_->offsets.size() - 1 : topology_->incidence_lists.size();
 }
 
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetEdgeCount() const {
-    return edges_.size();
+    return weights_.size();
+}
+
+template <typename Weight>
+Edge<Weight> DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
+    assert(edge_id < weights_.size());
+    const EdgeEnds& ends = topology_->edges[edge_id];
+    return {ends.from, ends.to, weights_[edge_id]};
 }
 
 template <typename Weight>
-const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
-    return edges_.at(edge_id);
+void DirectedWeightedGraph<Weight>::SetEdgeWeight(EdgeId edge_id, Weight weight) {
+    assert(edge_id < weights_.size());
+    weights_[edge_id] = weight;
 }
 
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-    return ranges::AsRange(incidence_lists_.at(vertex));
+    assert(vertex < GetVertexCount());
+    if (IsFrozen()) {
+        const auto& offsets = topology_->offsets;
+        return {IncidentEdgeIterator(nullptr, offsets[vertex]), IncidentEdgeIterator(nullptr, offsets[vertex + 1])};
+    }
+    const IncidenceList& edge_ids = topology_->incidence_lists[vertex];
+    return {IncidentEdgeIterator(edge_ids.data(), 0), IncidentEdgeIterator(edge_ids.data(), edge_ids.size())};
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::SharesTopologyWith(const DirectedWeightedGraph& other) const {
+    return topology_ == other.topology_;
 }
-}  // namespace graph
\ No newline at end of file
+}  // namespace graph
@@ -1,5 +1,7 @@
 #include "json.h"
 
+#include <sstream>
+
 using namespace std;
 
 namespace json {
@@ -320,6 +322,24 @@ Node::variant &Node::GetNodeType() {
     return *this;
 }
 
+RawValue::RawValue(const Node& node) {
+    std::ostringstream text;
+    PrintNode(node, PrintContext{ text });
+    text_ = std::make_shared<const std::string>(text.str());
+}
+
+const std::string& RawValue::GetText() const {
+    return *text_;
+}
+
+bool RawValue::operator==(const RawValue& rhs) const {
+    return *text_ == *rhs.text_;
+}
+
+bool RawValue::operator!=(const RawValue& rhs) const {
+    return !(*this == rhs);
+}
+
 Document::Document(Node root)
     : root_(std::move(root)) {
 }
@@ -402,6 +422,20 @@ void PrintValue(Dict dict, const PrintContext& ctx) {
     ctx.out << "}"sv;
 }
 
+void PrintValue(const RawValue& value, const PrintContext& ctx) {
+    const std::string& text = value.GetText();
+    size_t line_begin = 0;
+    for (size_t line_end = text.find('\n'); line_end != std::string::npos; line_end = text.find('\n', line_begin)) {
+        ctx.out.write(text.data() + line_begin, line_end + 1 - line_begin);
+        line_begin = line_end + 1;
+        // Пустые строки печатаются без отступа, как их печатает PrintValue для массивов и словарей
+        if (line_begin < text.size() && text[line_begin] != '\n') {
+            ctx.PrintIndent();
+        }
+    }
+    ctx.out.write(text.data() + line_begin, text.size() - line_begin);
+}
+
 void PrintNode(const Node& node, const PrintContext& ctx) {
     std::visit([&ctx](const auto& value) {
       PrintValue(value, ctx);
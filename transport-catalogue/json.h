@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <variant>
@@ -14,7 +15,23 @@ class Node;
 // Сохраните объявления Dict и Array без изменения
 using Dict = std::map<std::string, Node>;
 using Array = std::vector<Node>;
-using NodeType = std::variant<std::nullptr_t, std::string, int, double, bool, Array, Dict>;
+
+// Заранее напечатанное значение: текст выводится как есть, только к каждой
+// его строке добавляется отступ места вывода. Копии разделяют один текст
+class RawValue {
+public:
+    explicit RawValue(const Node& node);
+
+    const std::string& GetText() const;
+
+    bool operator==(const RawValue& rhs) const;
+    bool operator!=(const RawValue& rhs) const;
+
+private:
+    std::shared_ptr<const std::string> text_;
+};
+
+using NodeType = std::variant<std::nullptr_t, std::string, int, double, bool, Array, Dict, RawValue>;
 
 // Эта ошибка должна выбрасываться при ошибках парсинга JSON
 class ParsingError : public std::runtime_error {
@@ -93,6 +110,7 @@ void PrintValue(std::string value, const PrintContext& ctx);
 void PrintValue(bool value, const PrintContext& ctx);
 void PrintValue(Array array, const PrintContext& ctx);
 void PrintValue(Dict dict, const PrintContext& ctx);
+void PrintValue(const RawValue& value, const PrintContext& ctx);
 template <typename Value>
 void PrintValue(const Value& value, const PrintContext& ctx) {
     ctx.out << value;
@@ -147,6 +147,9 @@ Node Builder::GetNode(NodeType value) {
     if (std::holds_alternative<Array>(value)) {
         return Node(std::get<Array>(value));
     }
+    if (std::holds_alternative<RawValue>(value)) {
+        return Node(std::get<RawValue>(value));
+    }
     return {};
 }
 
@@ -2,7 +2,9 @@
  #include "json_reader.h"
  #include "transport_router.h"
  
+ #include <map>
  #include <sstream>
+ #include <unordered_map>
 
  using namespace std::literals;
   
@@ -41,6 +43,15 @@
     }
     return it->second;
 }
+
+const json::Node& JsonReader::GetSerializationSettings() const {
+    const auto& map = input_.GetRoot().AsDict();
+    auto it = map.find("serialization_settings"s);
+    if (it == map.end()) {
+        return dummy_;
+    }
+    return it->second;
+}
    
  void JsonReader::FillCatalogue(tc::TransportCatalogue& catalogue) {
     const json::Array& arr = GetBaseRequests().AsArray();
@@ -48,10 +59,11 @@
     AddStops(stops_requests, catalogue);
     FillStopDistances(catalogue, stops_requests);
     AddBuses(buses_requests, catalogue);
+    catalogue.Freeze();
  }
    
 const tc::Stop JsonReader::FillStop(const json::Dict& request_map) const {
-     std::string stop_name = request_map.at("name"s).AsString();
+     const std::string& stop_name = request_map.at("name"s).AsString();
      geo::Coordinates coordinates = { request_map.at("latitude"s).AsDouble(), request_map.at("longitude"s).AsDouble() };
      return {stop_name, coordinates};
  }
@@ -71,12 +83,89 @@ const tc::Stop JsonReader::FillStop(const json::Dict& request_map) const {
  }
 
 tc::router::RoutingSettings JsonReader::FillRoutingSettings(const json::Node& settings) const {
-    std::chrono::minutes bus_wait_time = std::chrono::minutes(settings.AsDict().at("bus_wait_time"s).AsInt());
-    return tc::router::RoutingSettings{bus_wait_time, settings.AsDict().at("bus_velocity"s).AsDouble() };
+    const json::Dict& settings_map = settings.AsDict();
+    std::chrono::minutes bus_wait_time = std::chrono::minutes(settings_map.at("bus_wait_time"s).AsInt());
+    tc::router::RoutingSettings routing_settings{bus_wait_time, settings_map.at("bus_velocity"s).AsDouble() };
+    return ReadRoutingSettings(settings_map, routing_settings);
+ }
+
+// Профили - словарь routing_settings.profiles: имя -> настройки. Не указанные
+// в профиле настройки берутся из основных
+void JsonReader::FillRoutingProfiles(const json::Node& settings, tc::router::RoutingProfiles& profiles) const {
+    const json::Dict& settings_map = settings.AsDict();
+    const auto it = settings_map.find("profiles"s);
+    if (it == settings_map.end()) {
+        return;
+    }
+    const tc::router::RoutingSettings& main_settings = profiles.GetMainProfile().GetSettings();
+    for (const auto& [name, profile_settings] : it->second.AsDict()) {
+        profiles.AddProfile(name, ReadRoutingSettings(profile_settings.AsDict(), main_settings));
+    }
+}
+
+tc::router::RoutingSettings JsonReader::ReadRoutingSettings(const json::Dict& settings_map,
+                                                            tc::router::RoutingSettings routing_settings) const {
+    if (auto it = settings_map.find("bus_wait_time"s); it != settings_map.end()) {
+        routing_settings.bus_wait_time = std::chrono::minutes(it->second.AsInt());
+    }
+    if (auto it = settings_map.find("bus_velocity"s); it != settings_map.end()) {
+        routing_settings.bus_velocity = it->second.AsDouble();
+    }
+    if (auto it = settings_map.find("router"s); it != settings_map.end()) {
+        routing_settings.router_type = ReadRouterType(it->second);
+    }
+    if (auto it = settings_map.find("graph_model"s); it != settings_map.end()) {
+        routing_settings.graph_model = ReadGraphModel(it->second);
+    }
+    if (auto it = settings_map.find("router_threads"s); it != settings_map.end()) {
+        const int router_threads = it->second.AsInt();
+        if (router_threads < 0) {
+            throw std::logic_error("wrong router threads"s);
+        }
+        routing_settings.router_threads = static_cast<size_t>(router_threads);
+    }
+    if (auto it = settings_map.find("prune_dominated_edges"s); it != settings_map.end()) {
+        routing_settings.prune_dominated_edges = it->second.AsBool();
+    }
+    return routing_settings;
+ }
+
+tc::router::RouterType JsonReader::ReadRouterType(const json::Node& json) const {
+    const std::string& router_type = json.AsString();
+    if (router_type == "all_pairs"s) {
+        return tc::router::RouterType::ALL_PAIRS;
+    }
+    if (router_type == "dijkstra"s) {
+        return tc::router::RouterType::DIJKSTRA;
+    }
+    if (router_type == "contraction_hierarchy"s) {
+        return tc::router::RouterType::CONTRACTION_HIERARCHY;
+    }
+    if (router_type == "raptor"s) {
+        return tc::router::RouterType::RAPTOR;
+    }
+    if (router_type == "astar"s) {
+        return tc::router::RouterType::ASTAR;
+    }
+    throw std::logic_error("wrong router type"s);
+ }
+
+tc::router::GraphModel JsonReader::ReadGraphModel(const json::Node& json) const {
+    const std::string& graph_model = json.AsString();
+    if (graph_model == "complete"s) {
+        return tc::router::GraphModel::COMPLETE;
+    }
+    if (graph_model == "linear"s) {
+        return tc::router::GraphModel::LINEAR;
+    }
+    if (graph_model == "single_vertex"s) {
+        return tc::router::GraphModel::SINGLE_VERTEX;
+    }
+    throw std::logic_error("wrong graph model"s);
  }
    
-const tc::Bus JsonReader::FillRoute(const json::Dict& request_map, tc::TransportCatalogue& catalogue) const {
-     std::string bus_number = request_map.at("name"s).AsString();
+tc::Bus JsonReader::FillRoute(const json::Dict& request_map, tc::TransportCatalogue& catalogue) const {
+     const std::string& bus_number = request_map.at("name"s).AsString();
      tc::Route stops;
     bool circular_route = request_map.at("is_roundtrip"s).AsBool();
     for (const auto& stop : request_map.at("stops"s).AsArray()) {
@@ -85,7 +174,7 @@ const tc::Bus JsonReader::FillRoute(const json::Dict& request_map, tc::Transport
     if (!circular_route) {
          stops.insert(stops.end(), std::next(stops.rbegin()), stops.rend());
     }
-    return {bus_number, stops, circular_route};
+    return {bus_number, std::move(stops), circular_route};
  }
   
   
@@ -117,8 +206,7 @@ const tc::Bus JsonReader::FillRoute(const json::Dict& request_map, tc::Transport
      for (const auto& request : buses_requests) {
          const auto& request_bus_map = request.AsDict();
          {
-             const auto& bus = FillRoute(request_bus_map, catalogue);
-             catalogue.AddBus(bus);
+             catalogue.AddBus(FillRoute(request_bus_map, catalogue));
          }
      }
  }
@@ -172,10 +260,13 @@ const tc::Bus JsonReader::FillRoute(const json::Dict& request_map, tc::Transport
   
  void JsonReader::ProcessRequests(const json::Node& stat_requests, RequestHandler& rh) const {
      json::Builder json_builder;
+     const json::Array& requests = stat_requests.AsArray();
+     std::vector<tc::router::RouteInfo> route_storage;
+     const auto routes = FindRoutes(requests, rh, route_storage);
      
      json_builder.StartArray();
-        for (const auto& request : stat_requests.AsArray()) {
-         const auto& request_map = request.AsDict();
+        for (size_t i = 0; i < requests.size(); ++i) {
+         const auto& request_map = requests[i].AsDict();
          json_builder.StartDict()
          .Key("request_id").Value(request_map.at("id"s).AsInt());
          const auto& type = request_map.at("type"s).AsString();
@@ -190,8 +281,14 @@ const tc::Bus JsonReader::FillRoute(const json::Dict& request_map, tc::Transport
             PrintMap(json_builder, rh);
          }
          if (type == "Route"s) {
-            PrintRoute(json_builder, request_map, rh);
+            PrintRoute(json_builder, routes[i]);
         }
+         if (type == "Matrix"s) {
+            PrintMatrix(json_builder, request_map, rh);
+         }
+         if (type == "Isochrone"s) {
+            PrintIsochrone(json_builder, request_map, rh);
+         }
         json_builder.EndDict();
      }
     json_builder.EndArray();
@@ -214,21 +311,30 @@ const tc::Bus JsonReader::FillRoute(const json::Dict& request_map, tc::Transport
  }
    
  void JsonReader::PrintStop(json::Builder& builder, const json::Dict& request_map, RequestHandler& rh) const {
-     json::Node result;
-     const std::string& stop_name = request_map.at("name"s).AsString();
-     if (!rh.IsStopName(stop_name)) {
+     const tc::Stop* stop = rh.GetStop(request_map.at("name"s).AsString());
+     if (stop == nullptr) {
             builder.Key("error_message"s).Value("not found"s);     
     }
      else {
-        const auto sorted_buses = rh.GetBusesToStop(stop_name);
-         json::Array buses;
-         for (const auto& bus_name: *sorted_buses) {
-            buses.push_back(bus_name->name_);
-         }
-            builder.Key("buses"s).Value(buses);
+            builder.Key("buses"s).Value(GetStopBusesJson(stop, rh));
      }
    
  }
+
+const json::RawValue& JsonReader::GetStopBusesJson(const tc::Stop* stop, RequestHandler& rh) const {
+    if (stop->id_ >= stop_buses_json_.size()) {
+        stop_buses_json_.resize(stop->id_ + 1);
+    }
+    auto& buses_json = stop_buses_json_[stop->id_];
+    if (!buses_json) {
+        json::Array buses;
+        for (const tc::Bus* bus : rh.GetSortedBusesToStop(stop)) {
+            buses.push_back(std::string(bus->name_));
+        }
+        buses_json.emplace(json::Node(std::move(buses)));
+    }
+    return *buses_json;
+}
   
  void JsonReader::PrintMap(json::Builder& builder, RequestHandler& rh) const {
      std::ostringstream strm;
@@ -239,13 +345,56 @@ const tc::Bus JsonReader::FillRoute(const json::Dict& request_map, tc::Transport
  }
 
   
-void JsonReader::PrintRoute(json::Builder& builder, const json::Dict& request_map, RequestHandler& rh) const {
-    json::Node result;
-    std::string from = request_map.at("from"s).AsString();
-    std::string to = request_map.at("to"s).AsString();
-    const auto route = rh.FindRoute(from, to);
-    //.Key("error_message"s).Value("not found"s);
-    if (!route.has_value()) {
+// Маршруты для всех запросов Route, сгруппированных по профилю и остановке отправления:
+// на каждую такую пару приходится один вызов маршрутизатора. Маршруты группы живут
+// в контексте запросов только до следующей группы, а печатаются в порядке запросов,
+// поэтому каждый найденный маршрут один раз копируется в route_storage
+std::vector<const tc::router::RouteInfo*> JsonReader::FindRoutes(const json::Array& stat_requests, RequestHandler& rh,
+                                                                 std::vector<tc::router::RouteInfo>& route_storage) const {
+    std::vector<const tc::router::RouteInfo*> routes(stat_requests.size(), nullptr);
+    std::map<std::pair<std::string_view, std::string_view>, std::vector<size_t>> requests_by_from;
+    for (size_t i = 0; i < stat_requests.size(); ++i) {
+        const auto& request_map = stat_requests[i].AsDict();
+        if (request_map.at("type"s).AsString() == "Route"s) {
+            requests_by_from[{ReadProfile(request_map), request_map.at("from"s).AsString()}].push_back(i);
+        }
+    }
+
+    // Место под все маршруты выделяется до того, как на него появятся указатели
+    size_t route_count = 0;
+    for (const auto& [profile_and_from, request_ids] : requests_by_from) {
+        route_count += request_ids.size();
+    }
+    route_storage.clear();
+    route_storage.resize(route_count);
+
+    size_t next_route = 0;
+    for (const auto& [profile_and_from, request_ids] : requests_by_from) {
+        const auto& [profile, from] = profile_and_from;
+        std::vector<std::string_view> stops_to;
+        stops_to.reserve(request_ids.size());
+        for (const size_t request_id : request_ids) {
+            stops_to.push_back(stat_requests[request_id].AsDict().at("to"s).AsString());
+        }
+        const auto from_routes = rh.FindRoutes(from, stops_to, profile);
+        for (size_t i = 0; i < request_ids.size(); ++i) {
+            if (from_routes[i] != nullptr) {
+                route_storage[next_route] = *from_routes[i];
+                routes[request_ids[i]] = &route_storage[next_route++];
+            }
+        }
+    }
+    return routes;
+}
+
+// Профиль маршрутизатора запроса; пустое имя - основной профиль
+std::string_view JsonReader::ReadProfile(const json::Dict& request_map) const {
+    const auto it = request_map.find("profile"s);
+    return it == request_map.end() ? std::string_view{} : std::string_view(it->second.AsString());
+}
+
+void JsonReader::PrintRoute(json::Builder& builder, const tc::router::RouteInfo* route) const {
+    if (route == nullptr) {
         builder.Key("error_message"s).Value("not found"s);
         return;
     }
@@ -263,11 +412,64 @@ void JsonReader::PrintRoute(json::Builder& builder, const json::Dict& request_ma
 
 }
 
+void JsonReader::PrintMatrix(json::Builder& builder, const json::Dict& request_map, RequestHandler& rh) const {
+    auto read_stop_names = [](const json::Node& names) {
+        std::vector<std::string_view> stop_names;
+        stop_names.reserve(names.AsArray().size());
+        for (const auto& name : names.AsArray()) {
+            stop_names.push_back(name.AsString());
+        }
+        return stop_names;
+    };
+    const auto stops_from = read_stop_names(request_map.at("from"s));
+    const auto stops_to = read_stop_names(request_map.at("to"s));
+    const auto travel_times = rh.ComputeTravelTimes(stops_from, stops_to, ReadProfile(request_map));
+    if (!travel_times) {
+        builder.Key("error_message"s).Value("not found"s);
+        return;
+    }
+
+    // Недостижимые пары - null
+    builder.Key("total_times"s).StartArray();
+    for (size_t row = 0; row < stops_from.size(); ++row) {
+        builder.StartArray();
+        for (size_t column = 0; column < stops_to.size(); ++column) {
+            const auto& travel_time = (*travel_times)[row * stops_to.size() + column];
+            if (travel_time) {
+                builder.Value(travel_time->count());
+            } else {
+                builder.Value(nullptr);
+            }
+        }
+        builder.EndArray();
+    }
+    builder.EndArray();
+}
+
+void JsonReader::PrintIsochrone(json::Builder& builder, const json::Dict& request_map, RequestHandler& rh) const {
+    const auto reachable_stops = rh.FindReachableStops(request_map.at("from"s).AsString(),
+                                                       tc::router::Minutes(request_map.at("max_time"s).AsDouble()),
+                                                       ReadProfile(request_map));
+    if (!reachable_stops) {
+        builder.Key("error_message"s).Value("not found"s);
+        return;
+    }
+
+    builder.Key("stops"s).StartArray();
+    for (const auto& [stop, time] : *reachable_stops) {
+        builder.StartDict()
+            .Key("stop_name"s).Value(std::string(stop->name_))
+            .Key("time"s).Value(time.count())
+        .EndDict();
+    }
+    builder.EndArray();
+}
+
 void JsonReader::BuildRouteItem(json::Builder& builder, const tc::router::RouteInfo::BusItem& item) const {
   
     builder.StartDict()
       .Key("type"s).Value("Bus"s)
-      .Key("bus"s).Value(item.bus->name_)
+      .Key("bus"s).Value(std::string(item.bus->name_))
       .Key("time"s).Value(item.time.count())
       .Key("span_count"s).Value(static_cast<int>(item.span_count))
       .EndDict();
@@ -277,7 +479,7 @@ void JsonReader::BuildRouteItem(json::Builder& builder, const tc::router::RouteI
   
     builder.StartDict()
       .Key("type"s).Value("Wait"s)
-      .Key("stop_name"s).Value(item.stop->name_)
+      .Key("stop_name"s).Value(std::string(item.stop->name_))
       .Key("time"s).Value(item.time.count())
       .EndDict();
 }
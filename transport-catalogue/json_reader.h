@@ -7,6 +7,8 @@
 #include "request_handler.h"
 
 #include <iostream>
+#include <optional>
+#include <vector>
 
 class JsonReader {
 public:
@@ -18,29 +20,45 @@ public:
     const json::Node& GetStatRequests() const;
     const json::Node& GetRenderSettings() const;
     const json::Node& GetRoutingSettings() const;
+    const json::Node& GetSerializationSettings() const;
 
     void FillCatalogue(tc::TransportCatalogue& catalogue);
     renderer::MapRenderer FillRenderSettings(const json::Dict& request_map) const;
     tc::router::RoutingSettings FillRoutingSettings(const json::Node& settings) const;
+    void FillRoutingProfiles(const json::Node& settings, tc::router::RoutingProfiles& profiles) const;
 
     void ProcessRequests(const json::Node& stat_requests, RequestHandler& rh) const;
 
 private:
     json::Document input_;
     json::Node dummy_ = nullptr;
+    // Напечатанные списки автобусов ответов Stop по номеру остановки, заполняются по мере запросов
+    mutable std::vector<std::optional<json::RawValue>> stop_buses_json_;
 
     const tc::Stop FillStop(const json::Dict& request_map) const;
     void FillStopDistances(tc::TransportCatalogue& catalogue, const json::Array& stops_requests) const;
-    const tc::Bus FillRoute(const json::Dict& request_map, tc::TransportCatalogue& catalogue) const;
+    tc::Bus FillRoute(const json::Dict& request_map, tc::TransportCatalogue& catalogue) const;
     const std::tuple<json::Array, json::Array> SortedRequests(const json::Array& base_request) const;
     void AddStops(const json::Array& stops_requests, tc::TransportCatalogue& catalogue);
     void AddBuses(const json::Array& buses_requests, tc::TransportCatalogue& catalogue);
     std::vector<svg::Color> ReadColors(const json::Array &json) const ;
     svg::Color ReadColor(const json::Node &json) const ;
+    // Настройки из settings_map поверх routing_settings: отсутствующие в settings_map не меняются
+    tc::router::RoutingSettings ReadRoutingSettings(const json::Dict& settings_map,
+                                                    tc::router::RoutingSettings routing_settings) const;
+    tc::router::RouterType ReadRouterType(const json::Node& json) const;
+    tc::router::GraphModel ReadGraphModel(const json::Node& json) const;
     void PrintBus(json::Builder& builder, const json::Dict& request_map, RequestHandler& rh) const;
     void PrintStop(json::Builder& builder, const json::Dict& request_map, RequestHandler& rh) const;
+    const json::RawValue& GetStopBusesJson(const tc::Stop* stop, RequestHandler& rh) const;
     void PrintMap(json::Builder& builder, RequestHandler& rh) const;
-    void PrintRoute(json::Builder& builder, const json::Dict& request_map, RequestHandler& rh) const;
+    std::string_view ReadProfile(const json::Dict& request_map) const;
+    void PrintRoute(json::Builder& builder, const tc::router::RouteInfo* route) const;
+    void PrintMatrix(json::Builder& builder, const json::Dict& request_map, RequestHandler& rh) const;
+    void PrintIsochrone(json::Builder& builder, const json::Dict& request_map, RequestHandler& rh) const;
+    // Маршруты по номеру запроса; nullptr для запросов не Route и ненайденных маршрутов
+    std::vector<const tc::router::RouteInfo*> FindRoutes(const json::Array& stat_requests, RequestHandler& rh,
+                                                         std::vector<tc::router::RouteInfo>& route_storage) const;
     void BuildRouteItem(json::Builder& builder, const tc::router::RouteInfo::WaitItem& item) const;
     void BuildRouteItem(json::Builder& builder, const tc::router::RouteInfo::BusItem& item) const;
     
@@ -1,18 +1,131 @@
 #include "json_reader.h"
 #include "request_handler.h"
- 
-int main() {
+#include "serialization.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+
+using namespace std::literals;
+
+namespace {
+
+void PrintUsage(std::ostream& stream = std::cerr) {
+    stream << "Usage: transport_catalogue [make_base|process_requests|memory_report]\n"sv;
+}
+
+// Сколько рёбер удалило прореживание графа. Пишется в stderr, чтобы не смешиваться с ответами
+void ReportPrunedEdges(const tc::router::TransportRouter& router) {
+    if (router.GetSettings().prune_dominated_edges) {
+        std::cerr << "Pruned dominated edges: "sv << router.GetPrunedEdgeCount() << '\n';
+    }
+}
+
+// Справочник, маршрутизатор и настройки отрисовки строятся по base_requests
+// и сохраняются в снимок serialization_settings.file
+void MakeBase() {
     tc::TransportCatalogue catalogue;
     JsonReader json_doc(std::cin);
-     
     json_doc.FillCatalogue(catalogue);
-     
-    const auto& stat_requests = json_doc.GetStatRequests();
-    const auto& renderer = json_doc.FillRenderSettings(json_doc.GetRenderSettings().AsDict());
+
     const auto& routing_settings = json_doc.FillRoutingSettings(json_doc.GetRoutingSettings());
     const tc::router::TransportRouter router = { routing_settings, catalogue };
-     
-    RequestHandler rh(catalogue, renderer, router);
-    json_doc.ProcessRequests(stat_requests, rh);
+    ReportPrunedEdges(router);
+    tc::router::RoutingProfiles profiles(router);
+    json_doc.FillRoutingProfiles(json_doc.GetRoutingSettings(), profiles);
+
+    // Снимок пишется рядом и подменяет прежний переименованием: работающие процессы
+    // отображают прежний файл в память, и его нельзя обрезать или переписывать под ними
+    const std::string& path = json_doc.GetSerializationSettings().AsDict().at("file"s).AsString();
+    const std::string temp_path = path + ".tmp"s;
+    std::ofstream output(temp_path, std::ios::binary);
+    serialization::SnapshotWriter writer(output);
+    serialization::SaveCatalogue(writer, catalogue);
+    std::ostringstream render_settings;
+    json::Print(json::Document{ json_doc.GetRenderSettings() }, render_settings);
+    writer.WriteString(render_settings.str());
+    router.Save(writer);
+    profiles.Save(writer);
+    output.close();
+    if (!output) {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Can't write snapshot " + temp_path);
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Can't replace snapshot " + path);
+    }
+}
+
+// Запросы stat_requests обрабатываются по снимку без перестроения маршрутизатора
+void ProcessRequests() {
+    JsonReader json_doc(std::cin);
+    const std::string& path = json_doc.GetSerializationSettings().AsDict().at("file"s).AsString();
+    serialization::SnapshotReader reader(path);
+
+    tc::TransportCatalogue catalogue;
+    serialization::LoadCatalogue(reader, catalogue);
+    std::istringstream render_settings_input{std::string(reader.ReadString())};
+    const json::Document render_settings = json::Load(render_settings_input);
+    const auto& renderer = json_doc.FillRenderSettings(render_settings.GetRoot().AsDict());
+    const tc::router::TransportRouter router(catalogue, reader);
+    const tc::router::RoutingProfiles profiles(router, reader);
+
+    RequestHandler rh(catalogue, renderer, profiles);
+    json_doc.ProcessRequests(json_doc.GetStatRequests(), rh);
+}
+
+// Размер таблицы маршрутизатора всех пар для графа, который строится по base_requests
+// и routing_settings. Сама таблица для отчёта не считается
+void ReportMemory() {
+    tc::TransportCatalogue catalogue;
+    JsonReader json_doc(std::cin);
+    json_doc.FillCatalogue(catalogue);
+
+    auto routing_settings = json_doc.FillRoutingSettings(json_doc.GetRoutingSettings());
+    routing_settings.router_type = tc::router::RouterType::DIJKSTRA;
+    const tc::router::TransportRouter router(routing_settings, catalogue);
+    ReportPrunedEdges(router);
+    graph::Router<tc::router::Minutes>::PrintMemoryReport(std::cout, router.GetGraph().GetVertexCount());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc == 1) {
+        tc::TransportCatalogue catalogue;
+        JsonReader json_doc(std::cin);
+
+        json_doc.FillCatalogue(catalogue);
+
+        const auto& stat_requests = json_doc.GetStatRequests();
+        const auto& renderer = json_doc.FillRenderSettings(json_doc.GetRenderSettings().AsDict());
+        const auto& routing_settings = json_doc.FillRoutingSettings(json_doc.GetRoutingSettings());
+        const tc::router::TransportRouter router = { routing_settings, catalogue };
+        ReportPrunedEdges(router);
+        tc::router::RoutingProfiles profiles(router);
+        json_doc.FillRoutingProfiles(json_doc.GetRoutingSettings(), profiles);
+
+        RequestHandler rh(catalogue, renderer, profiles);
+        json_doc.ProcessRequests(stat_requests, rh);
+        return 0;
+    }
 
+    const std::string_view mode(argv[1]);
+    if (argc != 2) {
+        PrintUsage();
+        return 1;
+    }
+    if (mode == "make_base"sv) {
+        MakeBase();
+    } else if (mode == "process_requests"sv) {
+        ProcessRequests();
+    } else if (mode == "memory_report"sv) {
+        ReportMemory();
+    } else {
+        PrintUsage();
+        return 1;
+    }
 }
@@ -8,15 +8,15 @@ bool IsZero(double value) {
      return std::abs(value) < EPSILON;
 }
  
-std::vector<svg::Polyline> MapRenderer::GetRouteLines(const std::deque<tc::Bus>& buses, const SphereProjector& sp) const {
+std::vector<svg::Polyline> MapRenderer::GetRouteLines(const std::vector<const tc::Bus*>& buses, const SphereProjector& sp) const {
     std::vector<svg::Polyline> result;
     size_t color_num = 0;
-    for (const auto& bus: buses) {
-        if (bus.stops_.empty()) {
+    for (const tc::Bus* bus : buses) {
+        if (bus->stops_.empty()) {
             continue;
         }
         svg::Polyline line;
-        for (const auto& stop : bus.stops_) {
+        for (const auto& stop : bus->stops_) {
             line.AddPoint(sp(stop->coordinates_));
         }
         line.SetStrokeColor(render_settings_.color_palette[color_num]);
@@ -38,21 +38,21 @@ std::vector<svg::Polyline> MapRenderer::GetRouteLines(const std::deque<tc::Bus>&
     return result;
 }
 
- std::vector<svg::Text> MapRenderer::GetBusLabel(const std::deque<tc::Bus>& buses, const SphereProjector& sp) const {
+ std::vector<svg::Text> MapRenderer::GetBusLabel(const std::vector<const tc::Bus*>& buses, const SphereProjector& sp) const {
     std::vector<svg::Text> result;
     size_t color_num = 0;
-    for (const auto& bus : buses) {
-        if (bus.stops_.empty()) {
+    for (const tc::Bus* bus : buses) {
+        if (bus->stops_.empty()) {
             continue;
         }
         svg::Text text;
         svg::Text underlayer;
-        text.SetPosition(sp(bus.stops_[0]->coordinates_));
+        text.SetPosition(sp(bus->stops_[0]->coordinates_));
         text.SetOffset(render_settings_.bus_label_offset);
         text.SetFontSize(render_settings_.bus_label_font_size);
         text.SetFontFamily("Verdana");
         text.SetFontWeight("bold");
-        text.SetData(bus.name_);
+        text.SetData(std::string(bus->name_));
         text.SetFillColor(render_settings_.color_palette[color_num]);
         if (color_num < (render_settings_.color_palette.size() - 1)) {
             ++color_num;
@@ -60,12 +60,12 @@ std::vector<svg::Polyline> MapRenderer::GetRouteLines(const std::deque<tc::Bus>&
         else {
             color_num = 0;
         }
-        underlayer.SetPosition(sp(bus.stops_[0]->coordinates_));
+        underlayer.SetPosition(sp(bus->stops_[0]->coordinates_));
         underlayer.SetOffset(render_settings_.bus_label_offset);
         underlayer.SetFontSize(render_settings_.bus_label_font_size);
         underlayer.SetFontFamily("Verdana");
         underlayer.SetFontWeight("bold");
-        underlayer.SetData(bus.name_);
+        underlayer.SetData(std::string(bus->name_));
         underlayer.SetFillColor(render_settings_.underlayer_color);
         underlayer.SetStrokeColor(render_settings_.underlayer_color);
         underlayer.SetStrokeWidth(render_settings_.underlayer_width);
@@ -75,11 +75,11 @@ std::vector<svg::Polyline> MapRenderer::GetRouteLines(const std::deque<tc::Bus>&
         result.push_back(underlayer);
         result.push_back(text);
         
-        if (!bus.is_circle_ && bus.stops_[0] != bus.stops_[bus.stops_.size()/2]) {
+        if (!bus->is_circle_ && bus->stops_[0] != bus->stops_[bus->stops_.size()/2]) {
             svg::Text text2 {text};
             svg::Text underlayer2 {underlayer};
-            text2.SetPosition(sp(bus.stops_[bus.stops_.size()/2]->coordinates_));
-            underlayer2.SetPosition(sp(bus.stops_[bus.stops_.size()/2]->coordinates_));
+            text2.SetPosition(sp(bus->stops_[bus->stops_.size()/2]->coordinates_));
+            underlayer2.SetPosition(sp(bus->stops_[bus->stops_.size()/2]->coordinates_));
             
             result.push_back(underlayer2);
             result.push_back(text2);
@@ -112,14 +112,14 @@ std::vector<svg::Text> MapRenderer::GetStopsLabels(std::map<std::string_view, co
         text.SetOffset(render_settings_.stop_label_offset);
         text.SetFontSize(render_settings_.stop_label_font_size);
         text.SetFontFamily("Verdana");
-        text.SetData(stop->name_);
+        text.SetData(std::string(stop->name_));
         text.SetFillColor("black");
         
         underlayer.SetPosition(sp(stop->coordinates_));
         underlayer.SetOffset(render_settings_.stop_label_offset);
         underlayer.SetFontSize(render_settings_.stop_label_font_size);
         underlayer.SetFontFamily("Verdana");
-        underlayer.SetData(stop->name_);
+        underlayer.SetData(std::string(stop->name_));
         underlayer.SetFillColor(render_settings_.underlayer_color);
         underlayer.SetStrokeColor(render_settings_.underlayer_color);
         underlayer.SetStrokeWidth(render_settings_.underlayer_width);
@@ -133,16 +133,16 @@ std::vector<svg::Text> MapRenderer::GetStopsLabels(std::map<std::string_view, co
     return result;
 }
  
- svg::Document MapRenderer::GetSVG(const std::deque<tc::Bus>& buses) const {
+ svg::Document MapRenderer::GetSVG(const std::vector<const tc::Bus*>& buses) const {
     svg::Document result;
     std::vector<geo::Coordinates> route_stops_coord;
     std::map<std::string_view, const tc::Stop*> all_stops;
     
-    for (const auto&  bus : buses) {
-        if (bus.stops_.empty()) {
+    for (const tc::Bus* bus : buses) {
+        if (bus->stops_.empty()) {
             continue;
         }
-        for (const auto& stop : bus.stops_) {
+        for (const auto& stop : bus->stops_) {
             route_stops_coord.push_back(stop->coordinates_);
             all_stops[stop->name_] = stop;
         }
@@ -7,7 +7,9 @@
 #include "domain.h"
 
 #include <algorithm>
-#include <deque>
+#include <map>
+#include <string_view>
+#include <vector>
  
 namespace renderer {
  
@@ -102,15 +104,15 @@ public:
         : render_settings_(render_settings)
     {}
      
-    std::vector<svg::Polyline> GetRouteLines(const std::deque<tc::Bus>& buses, const SphereProjector& sp) const;
+    std::vector<svg::Polyline> GetRouteLines(const std::vector<const tc::Bus*>& buses, const SphereProjector& sp) const;
      
-    std::vector<svg::Text> GetBusLabel(const std::deque<tc::Bus>& buses, const SphereProjector& sp) const;
+    std::vector<svg::Text> GetBusLabel(const std::vector<const tc::Bus*>& buses, const SphereProjector& sp) const;
 
     std::vector<svg::Circle> GetStopsSymbols(std::map<std::string_view, const tc::Stop*> stops, const SphereProjector& sp) const;
 
     std::vector<svg::Text> GetStopsLabels(std::map<std::string_view, const tc::Stop*> stops, const SphereProjector& sp) const;
 
-    svg::Document GetSVG(const std::deque<tc::Bus>& buses) const;
+    svg::Document GetSVG(const std::vector<const tc::Bus*>& buses) const;
      
 private:
     const RenderSettings render_settings_;
@@ -0,0 +1,212 @@
+#include "min_plus.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MIN_PLUS_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace graph::min_plus {
+
+namespace {
+
+template <typename WeightRep>
+using RelaxRowFunction = void (*)(WeightRep, uint32_t, const WeightRep*, const uint32_t*,
+                                  WeightRep*, uint32_t*, size_t);
+
+template <typename WeightRep>
+void RelaxRowScalar(WeightRep weight_from, uint32_t prev_edge_from,
+                    const WeightRep* weights_through, const uint32_t* prev_edges_through,
+                    WeightRep* weights_from, uint32_t* prev_edges_from, size_t count) {
+    RelaxRow<WeightRep>(weight_from, prev_edge_from, weights_through, prev_edges_through,
+                        weights_from, prev_edges_from, count);
+}
+
+#ifdef MIN_PLUS_X86_KERNELS
+
+__attribute__((target("avx2")))
+void RelaxRowAvx2(double weight_from, uint32_t prev_edge_from,
+                  const double* weights_through, const uint32_t* prev_edges_through,
+                  double* weights_from, uint32_t* prev_edges_from, size_t count) {
+    const __m256d from = _mm256_set1_pd(weight_from);
+    const __m128i prev_from = _mm_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m128i no_edge = _mm_set1_epi32(static_cast<int>(NO_EDGE));
+    // Переставляет младшие половины 64-битных масок в нижние 128 бит
+    const __m256i mask_order = _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d candidate = _mm256_add_pd(from, _mm256_loadu_pd(weights_through + i));
+        const __m256d current = _mm256_loadu_pd(weights_from + i);
+        const __m256d less = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+        if (_mm256_movemask_pd(less) == 0) {
+            continue;
+        }
+        _mm256_storeu_pd(weights_from + i, _mm256_blendv_pd(current, candidate, less));
+
+        const __m128i less32 = _mm256_castsi256_si128(
+            _mm256_permutevar8x32_epi32(_mm256_castpd_si256(less), mask_order));
+        const __m128i through = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_through + i));
+        const __m128i candidate_prev = _mm_blendv_epi8(through, prev_from, _mm_cmpeq_epi32(through, no_edge));
+        __m128i* prev_ptr = reinterpret_cast<__m128i*>(prev_edges_from + i);
+        _mm_storeu_si128(prev_ptr, _mm_blendv_epi8(_mm_loadu_si128(prev_ptr), candidate_prev, less32));
+    }
+    RelaxRow<double>(weight_from, prev_edge_from, weights_through + i, prev_edges_through + i,
+                     weights_from + i, prev_edges_from + i, count - i);
+}
+
+__attribute__((target("avx2")))
+void RelaxRowAvx2(float weight_from, uint32_t prev_edge_from,
+                  const float* weights_through, const uint32_t* prev_edges_through,
+                  float* weights_from, uint32_t* prev_edges_from, size_t count) {
+    const __m256 from = _mm256_set1_ps(weight_from);
+    const __m256i prev_from = _mm256_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m256i no_edge = _mm256_set1_epi32(static_cast<int>(NO_EDGE));
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 candidate = _mm256_add_ps(from, _mm256_loadu_ps(weights_through + i));
+        const __m256 current = _mm256_loadu_ps(weights_from + i);
+        const __m256 less = _mm256_cmp_ps(candidate, current, _CMP_LT_OQ);
+        if (_mm256_movemask_ps(less) == 0) {
+            continue;
+        }
+        _mm256_storeu_ps(weights_from + i, _mm256_blendv_ps(current, candidate, less));
+
+        const __m256i through = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges_through + i));
+        const __m256i candidate_prev = _mm256_blendv_epi8(through, prev_from, _mm256_cmpeq_epi32(through, no_edge));
+        __m256i* prev_ptr = reinterpret_cast<__m256i*>(prev_edges_from + i);
+        _mm256_storeu_si256(prev_ptr, _mm256_blendv_epi8(_mm256_loadu_si256(prev_ptr), candidate_prev,
+                                                         _mm256_castps_si256(less)));
+    }
+    RelaxRow<float>(weight_from, prev_edge_from, weights_through + i, prev_edges_through + i,
+                    weights_from + i, prev_edges_from + i, count - i);
+}
+
+__attribute__((target("sse4.1")))
+void RelaxRowSse41(double weight_from, uint32_t prev_edge_from,
+                   const double* weights_through, const uint32_t* prev_edges_through,
+                   double* weights_from, uint32_t* prev_edges_from, size_t count) {
+    const __m128d from = _mm_set1_pd(weight_from);
+    const __m128i prev_from = _mm_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m128i no_edge = _mm_set1_epi32(static_cast<int>(NO_EDGE));
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128d candidate = _mm_add_pd(from, _mm_loadu_pd(weights_through + i));
+        const __m128d current = _mm_loadu_pd(weights_from + i);
+        const __m128d less = _mm_cmplt_pd(candidate, current);
+        if (_mm_movemask_pd(less) == 0) {
+            continue;
+        }
+        _mm_storeu_pd(weights_from + i, _mm_blendv_pd(current, candidate, less));
+
+        const __m128i less32 = _mm_shuffle_epi32(_mm_castpd_si128(less), _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128i through = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(prev_edges_through + i));
+        const __m128i candidate_prev = _mm_blendv_epi8(through, prev_from, _mm_cmpeq_epi32(through, no_edge));
+        __m128i* prev_ptr = reinterpret_cast<__m128i*>(prev_edges_from + i);
+        _mm_storel_epi64(prev_ptr, _mm_blendv_epi8(_mm_loadl_epi64(prev_ptr), candidate_prev, less32));
+    }
+    RelaxRow<double>(weight_from, prev_edge_from, weights_through + i, prev_edges_through + i,
+                     weights_from + i, prev_edges_from + i, count - i);
+}
+
+__attribute__((target("sse4.1")))
+void RelaxRowSse41(float weight_from, uint32_t prev_edge_from,
+                   const float* weights_through, const uint32_t* prev_edges_through,
+                   float* weights_from, uint32_t* prev_edges_from, size_t count) {
+    const __m128 from = _mm_set1_ps(weight_from);
+    const __m128i prev_from = _mm_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m128i no_edge = _mm_set1_epi32(static_cast<int>(NO_EDGE));
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 candidate = _mm_add_ps(from, _mm_loadu_ps(weights_through + i));
+        const __m128 current = _mm_loadu_ps(weights_from + i);
+        const __m128 less = _mm_cmplt_ps(candidate, current);
+        if (_mm_movemask_ps(less) == 0) {
+            continue;
+        }
+        _mm_storeu_ps(weights_from + i, _mm_blendv_ps(current, candidate, less));
+
+        const __m128i through = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_through + i));
+        const __m128i candidate_prev = _mm_blendv_epi8(through, prev_from, _mm_cmpeq_epi32(through, no_edge));
+        __m128i* prev_ptr = reinterpret_cast<__m128i*>(prev_edges_from + i);
+        _mm_storeu_si128(prev_ptr, _mm_blendv_epi8(_mm_loadu_si128(prev_ptr), candidate_prev,
+                                                   _mm_castps_si128(less)));
+    }
+    RelaxRow<float>(weight_from, prev_edge_from, weights_through + i, prev_edges_through + i,
+                    weights_from + i, prev_edges_from + i, count - i);
+}
+
+#endif  // MIN_PLUS_X86_KERNELS
+
+enum class Kernel {
+    SCALAR,
+    SSE41,
+    AVX2,
+};
+
+Kernel DetectKernel() {
+#ifdef MIN_PLUS_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return Kernel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return Kernel::SSE41;
+    }
+#endif
+    return Kernel::SCALAR;
+}
+
+Kernel GetKernel() {
+    static const Kernel kernel = DetectKernel();
+    return kernel;
+}
+
+template <typename WeightRep>
+RelaxRowFunction<WeightRep> SelectRelaxRow() {
+#ifdef MIN_PLUS_X86_KERNELS
+    switch (GetKernel()) {
+        case Kernel::AVX2:
+            return static_cast<RelaxRowFunction<WeightRep>>(RelaxRowAvx2);
+        case Kernel::SSE41:
+            return static_cast<RelaxRowFunction<WeightRep>>(RelaxRowSse41);
+        case Kernel::SCALAR:
+            break;
+    }
+#endif
+    return RelaxRowScalar<WeightRep>;
+}
+
+}  // namespace
+
+void RelaxRow(double weight_from, uint32_t prev_edge_from,
+              const double* weights_through, const uint32_t* prev_edges_through,
+              double* weights_from, uint32_t* prev_edges_from, size_t count) {
+    static const RelaxRowFunction<double> relax_row = SelectRelaxRow<double>();
+    relax_row(weight_from, prev_edge_from, weights_through, prev_edges_through,
+              weights_from, prev_edges_from, count);
+}
+
+void RelaxRow(float weight_from, uint32_t prev_edge_from,
+              const float* weights_through, const uint32_t* prev_edges_through,
+              float* weights_from, uint32_t* prev_edges_from, size_t count) {
+    static const RelaxRowFunction<float> relax_row = SelectRelaxRow<float>();
+    relax_row(weight_from, prev_edge_from, weights_through, prev_edges_through,
+              weights_from, prev_edges_from, count);
+}
+
+const char* GetKernelName() {
+    switch (GetKernel()) {
+        case Kernel::AVX2:
+            return "avx2";
+        case Kernel::SSE41:
+            return "sse4.1";
+        case Kernel::SCALAR:
+            break;
+    }
+    return "scalar";
+}
+
+}  // namespace graph::min_plus
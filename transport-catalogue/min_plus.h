@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace graph::min_plus {
+
+// Ребро, которым заканчивается маршрут из вершины в саму себя
+inline constexpr uint32_t NO_EDGE = UINT32_MAX;
+
+// Релаксация отрезка строки таблицы маршрутов через промежуточную вершину:
+// для каждого i, если weight_from + weights_through[i] < weights_from[i],
+// записывает новый вес и последнее ребро маршрута
+// (prev_edges_through[i], а если его нет - prev_edge_from).
+// Для double и float выбирается векторная реализация (AVX2 или SSE4.1),
+// доступная на текущем процессоре, иначе - скалярная
+void RelaxRow(double weight_from, uint32_t prev_edge_from,
+              const double* weights_through, const uint32_t* prev_edges_through,
+              double* weights_from, uint32_t* prev_edges_from, size_t count);
+
+void RelaxRow(float weight_from, uint32_t prev_edge_from,
+              const float* weights_through, const uint32_t* prev_edges_through,
+              float* weights_from, uint32_t* prev_edges_from, size_t count);
+
+template <typename WeightRep>
+void RelaxRow(WeightRep weight_from, uint32_t prev_edge_from,
+              const WeightRep* weights_through, const uint32_t* prev_edges_through,
+              WeightRep* weights_from, uint32_t* prev_edges_from, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const WeightRep candidate_weight = weight_from + weights_through[i];
+        if (candidate_weight < weights_from[i]) {
+            weights_from[i] = candidate_weight;
+            prev_edges_from[i] = prev_edges_through[i] != NO_EDGE ? prev_edges_through[i] : prev_edge_from;
+        }
+    }
+}
+
+// Название выбранной реализации: "avx2", "sse4.1" или "scalar"
+const char* GetKernelName();
+
+}  // namespace graph::min_plus
@@ -0,0 +1,29 @@
+#include "name_arena.h"
+
+#include <cstring>
+
+namespace tc {
+
+std::string_view NameArena::Add(std::string_view name) {
+    if (name.empty()) {
+        return {};
+    }
+    if (name.size() > BLOCK_SIZE / 4) {
+        // Длинное название получает свой блок, чтобы не бросать место в текущем
+        blocks_.push_back(std::make_unique<char[]>(name.size()));
+        std::memcpy(blocks_.back().get(), name.data(), name.size());
+        return {blocks_.back().get(), name.size()};
+    }
+    if (name.size() > free_size_) {
+        blocks_.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+        free_begin_ = blocks_.back().get();
+        free_size_ = BLOCK_SIZE;
+    }
+    char* data = free_begin_;
+    std::memcpy(data, name.data(), name.size());
+    free_begin_ += name.size();
+    free_size_ -= name.size();
+    return {data, name.size()};
+}
+
+}  // namespace tc
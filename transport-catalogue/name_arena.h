@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace tc {
+
+// Хранилище названий только на добавление: строки лежат подряд в крупных блоках
+// и не перемещаются, пока жива арена, поэтому на них можно держать string_view.
+// Блок выделяется один раз на много названий, а не по строке на каждое
+class NameArena {
+public:
+    NameArena() = default;
+    NameArena(const NameArena&) = delete;
+    NameArena& operator=(const NameArena&) = delete;
+    NameArena(NameArena&&) = default;
+    NameArena& operator=(NameArena&&) = default;
+
+    // Копирует название в арену и возвращает представление копии
+    std::string_view Add(std::string_view name);
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* free_begin_ = nullptr;  // Свободное место в последнем обычном блоке
+    size_t free_size_ = 0;
+};
+
+}  // namespace tc
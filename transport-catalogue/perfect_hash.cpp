@@ -0,0 +1,114 @@
+#include "perfect_hash.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace tc {
+
+namespace {
+
+// В среднем ключей на корзину: чем больше, тем меньше смещений, но дольше подбор
+const size_t KEYS_PER_BUCKET = 4;
+const uint32_t MAX_DISPLACEMENT = 1 << 20;
+const uint64_t MAX_SEED = 16;
+
+// Перемешивание splitmix64
+uint64_t Mix(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+}  // namespace
+
+PerfectHashIndex::PerfectHashIndex(const std::vector<std::pair<std::string_view, uint32_t>>& items) {
+    if (items.empty()) {
+        return;
+    }
+    std::vector<uint64_t> hashes;
+    hashes.reserve(items.size());
+    for (const auto& [key, value] : items) {
+        hashes.push_back(Hash(key));
+    }
+    // Одинаковые ключи не разделит никакое смещение
+    std::vector<size_t> order(items.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&items](size_t lhs, size_t rhs) {
+        return items[lhs].first < items[rhs].first;
+    });
+    for (size_t i = 1; i < order.size(); ++i) {
+        if (items[order[i - 1]].first == items[order[i]].first) {
+            throw std::invalid_argument("Duplicate key " + std::string(items[order[i]].first));
+        }
+    }
+
+    for (seed_ = 0; seed_ < MAX_SEED; ++seed_) {
+        if (TryBuild(items, hashes)) {
+            return;
+        }
+    }
+    throw std::runtime_error("Can't build a perfect hash");
+}
+
+uint64_t PerfectHashIndex::Hash(std::string_view key) {
+    return std::hash<std::string_view>{}(key);
+}
+
+size_t PerfectHashIndex::GetSlot(uint64_t hash, uint32_t displacement) const {
+    return Mix(hash ^ (seed_ << 32 | displacement)) % slots_.size();
+}
+
+bool PerfectHashIndex::TryBuild(const std::vector<std::pair<std::string_view, uint32_t>>& items,
+                                const std::vector<uint64_t>& hashes) {
+    const size_t bucket_count = (items.size() + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET;
+    displacements_.assign(bucket_count, 0);
+    slots_.assign(items.size(), Slot{});
+
+    std::vector<std::vector<size_t>> buckets(bucket_count);
+    for (size_t item = 0; item < items.size(); ++item) {
+        buckets[hashes[item] % bucket_count].push_back(item);
+    }
+    // Большие корзины труднее разместить, поэтому они идут первыми, пока таблица пуста
+    std::vector<size_t> bucket_order(bucket_count);
+    std::iota(bucket_order.begin(), bucket_order.end(), 0);
+    std::stable_sort(bucket_order.begin(), bucket_order.end(), [&buckets](size_t lhs, size_t rhs) {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+
+    std::vector<bool> occupied(items.size(), false);
+    std::vector<size_t> bucket_slots;
+    for (const size_t bucket : bucket_order) {
+        if (buckets[bucket].empty()) {
+            break;
+        }
+        bool placed = false;
+        for (uint32_t displacement = 0; !placed && displacement < MAX_DISPLACEMENT; ++displacement) {
+            bucket_slots.clear();
+            for (const size_t item : buckets[bucket]) {
+                const size_t slot = GetSlot(hashes[item], displacement);
+                if (occupied[slot] || std::find(bucket_slots.begin(), bucket_slots.end(), slot) != bucket_slots.end()) {
+                    break;
+                }
+                bucket_slots.push_back(slot);
+            }
+            if (bucket_slots.size() == buckets[bucket].size()) {
+                placed = true;
+                displacements_[bucket] = displacement;
+                for (size_t i = 0; i < bucket_slots.size(); ++i) {
+                    occupied[bucket_slots[i]] = true;
+                    slots_[bucket_slots[i]] = {items[buckets[bucket][i]].first, items[buckets[bucket][i]].second};
+                }
+            }
+        }
+        if (!placed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace tc
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace tc {
+
+// Минимальная совершенная хеш-таблица неизменного набора строк (hash-and-displace).
+// Ключи разложены по корзинам по хешу, и для каждой корзины подобрано смещение,
+// при котором её ключи попадают в свободные ячейки. Поиск - один хеш ключа,
+// одна ячейка и одно сравнение строк. Строки ключей таблица не хранит:
+// они должны жить дольше неё
+class PerfectHashIndex {
+public:
+    static constexpr uint32_t NOT_FOUND = std::numeric_limits<uint32_t>::max();
+
+    PerfectHashIndex() = default;
+    // Ключи должны быть различны, иначе бросается std::invalid_argument
+    explicit PerfectHashIndex(const std::vector<std::pair<std::string_view, uint32_t>>& items);
+
+    // Значение ключа или NOT_FOUND
+    uint32_t Find(std::string_view key) const {
+        if (slots_.empty()) {
+            return NOT_FOUND;
+        }
+        const uint64_t hash = Hash(key);
+        const Slot& slot = slots_[GetSlot(hash, displacements_[hash % displacements_.size()])];
+        return slot.key == key ? slot.value : NOT_FOUND;
+    }
+
+private:
+    struct Slot {
+        std::string_view key;
+        uint32_t value = NOT_FOUND;
+    };
+
+    static uint64_t Hash(std::string_view key);
+    size_t GetSlot(uint64_t hash, uint32_t displacement) const;
+    // false, если при этом seed_ не нашлось смещения для какой-то корзины
+    bool TryBuild(const std::vector<std::pair<std::string_view, uint32_t>>& items,
+                  const std::vector<uint64_t>& hashes);
+
+    uint64_t seed_ = 0;
+    std::vector<uint32_t> displacements_;  // По корзинам
+    std::vector<Slot> slots_;
+};
+
+}  // namespace tc
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Буферы одного поиска по графу: метки вершин, куча и рёбра найденного маршрута.
+// Метки не очищаются между поисками: каждая помечена номером поиска (поколением),
+// и метка прошлого поиска считается пустой. Поэтому Reset стоит O(1), а не O(V),
+// и после первых поисков контекст больше не выделяет память
+template <typename Weight>
+class QueryContext {
+public:
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    // Контекст текущего потока. Один поиск за раз: вложенные поиски
+    // в одном потоке должны заводить свои контексты
+    static QueryContext& ForCurrentThread() {
+        thread_local QueryContext context;
+        return context;
+    }
+
+    // Начинает новый поиск по графу с vertex_count вершинами
+    void Reset(size_t vertex_count) {
+        if (labels_.size() < vertex_count) {
+            labels_.resize(vertex_count);
+        }
+        if (++generation_ == 0) {
+            // Номера поисков исчерпаны: старые метки могли бы совпасть с новыми
+            std::fill(labels_.begin(), labels_.end(), Label{});
+            generation_ = 1;
+        }
+        heap_.clear();
+        route_edges_.clear();
+    }
+
+    bool IsReached(VertexId vertex) const {
+        return labels_[vertex].reached == generation_;
+    }
+    Weight GetWeight(VertexId vertex) const {
+        return labels_[vertex].weight;
+    }
+    // NO_EDGE - начало поиска
+    EdgeId GetPrevEdge(VertexId vertex) const {
+        return labels_[vertex].prev_edge;
+    }
+    void Reach(VertexId vertex, Weight weight, EdgeId prev_edge) {
+        Label& label = labels_[vertex];
+        label.weight = weight;
+        label.prev_edge = prev_edge;
+        label.reached = generation_;
+    }
+
+    bool IsSettled(VertexId vertex) const {
+        return labels_[vertex].settled == generation_;
+    }
+    void Settle(VertexId vertex) {
+        labels_[vertex].settled = generation_;
+    }
+
+    // Отметка вершин, например целей поиска
+    bool IsMarked(VertexId vertex) const {
+        return labels_[vertex].marked == generation_;
+    }
+    void Mark(VertexId vertex) {
+        labels_[vertex].marked = generation_;
+    }
+
+    // Куча с минимальным весом наверху
+    bool IsQueueEmpty() const {
+        return heap_.empty();
+    }
+    void Push(Weight weight, VertexId vertex) {
+        heap_.emplace_back(weight, vertex);
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<QueueItem>());
+    }
+    std::pair<Weight, VertexId> Pop() {
+        std::pop_heap(heap_.begin(), heap_.end(), std::greater<QueueItem>());
+        const QueueItem item = heap_.back();
+        heap_.pop_back();
+        return item;
+    }
+
+    // Рёбра маршрута, найденного последним поиском, от начала к концу
+    std::vector<EdgeId>& GetRouteEdges() {
+        return route_edges_;
+    }
+    const std::vector<EdgeId>& GetRouteEdges() const {
+        return route_edges_;
+    }
+
+private:
+    using QueueItem = std::pair<Weight, VertexId>;
+
+    struct Label {
+        Weight weight{};
+        EdgeId prev_edge = NO_EDGE;
+        uint32_t reached = 0;
+        uint32_t settled = 0;
+        uint32_t marked = 0;
+    };
+
+    std::vector<Label> labels_;
+    uint32_t generation_ = 0;
+    std::vector<QueueItem> heap_;
+    std::vector<EdgeId> route_edges_;
+};
+
+}  // namespace graph
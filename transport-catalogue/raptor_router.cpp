@@ -0,0 +1,198 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace tc::router {
+
+RaptorRouter::RaptorRouter(RoutingSettings settings, const TransportCatalogue& catalogue)
+  : settings_(settings) {
+  for (const auto& stop : catalogue.GetStops()) {
+    stops_.push_back(&stop);
+  }
+  stop_lines_.resize(stops_.size());
+
+  for (const auto& bus : catalogue.GetBuses()) {
+    const auto& bus_stops = bus.stops_;
+    if (bus_stops.size() <= 1) {
+      continue;
+    }
+    const size_t line_id = lines_.size();
+    Line& line = lines_.emplace_back(Line{&bus, {}, {}});
+    line.stops.reserve(bus_stops.size());
+    line.distances.reserve(bus_stops.size());
+
+    size_t distance = 0;
+    for (size_t position = 0; position < bus_stops.size(); ++position) {
+      if (position > 0) {
+        distance += catalogue.GetDistance(bus_stops[position - 1], bus_stops[position]);
+      }
+      const size_t stop = bus_stops[position]->id_;
+      line.stops.push_back(stop);
+      line.distances.push_back(distance);
+      stop_lines_[stop].push_back({line_id, position});
+    }
+  }
+}
+
+void RaptorRouter::ApplySettings(const RoutingSettings& settings) {
+  settings_ = settings;
+}
+
+Minutes RaptorRouter::ComputeRideTime(const Line& line, size_t board, size_t alight) const {
+  return router::ComputeRideTime(settings_, line.distances[alight] - line.distances[board]);
+}
+
+std::optional<RouteInfo> RaptorRouter::FindRoute(const Stop* from, const Stop* to) const {
+  const size_t target = to->id_;
+  return BuildRouteInfo(ComputeRounds(from->id_, target), target);
+}
+
+std::vector<std::optional<RouteInfo>> RaptorRouter::FindRoutes(const Stop* from,
+                                                               const std::vector<const Stop*>& to) const {
+  const auto rounds = ComputeRounds(from->id_, std::nullopt);
+  std::vector<std::optional<RouteInfo>> routes;
+  routes.reserve(to.size());
+  for (const Stop* stop : to) {
+    routes.push_back(BuildRouteInfo(rounds, stop->id_));
+  }
+  return routes;
+}
+
+std::vector<std::optional<Minutes>> RaptorRouter::ComputeTravelTimes(const Stop* from,
+                                                                     const std::vector<const Stop*>& to) const {
+  const auto rounds = ComputeRounds(from->id_, std::nullopt);
+  std::vector<std::optional<Minutes>> travel_times;
+  travel_times.reserve(to.size());
+  for (const Stop* stop : to) {
+    const size_t target = stop->id_;
+    const auto round = FindLastRound(rounds, target);
+    travel_times.push_back(round ? std::optional(rounds[*round][target]->time) : std::nullopt);
+  }
+  return travel_times;
+}
+
+std::vector<ReachableStop> RaptorRouter::FindReachableStops(const Stop* from, Minutes max_time) const {
+  const auto rounds = ComputeRounds(from->id_, std::nullopt, max_time);
+  std::vector<ReachableStop> reachable_stops;
+  for (size_t stop = 0; stop < stops_.size(); ++stop) {
+    if (const auto round = FindLastRound(rounds, stop)) {
+      reachable_stops.push_back({stops_[stop], rounds[*round][stop]->time});
+    }
+  }
+  return reachable_stops;
+}
+
+std::vector<RaptorRouter::Round> RaptorRouter::ComputeRounds(size_t source, std::optional<size_t> target,
+                                                             std::optional<Minutes> max_time) const {
+  std::vector<Round> rounds(1, Round(stops_.size()));
+  rounds[0][source] = Label{Minutes(0)};
+  if (source == target) {
+    return rounds;
+  }
+  std::vector<std::optional<Minutes>> best_times(stops_.size());
+  best_times[source] = Minutes(0);
+  std::vector<bool> marked(stops_.size(), false);
+  marked[source] = true;
+
+  // Для каждой линии - первая позиция, с которой в этом раунде имеет смысл сесть
+  std::vector<std::optional<size_t>> lines_to_scan(lines_.size());
+  for (bool has_marked = true; has_marked;) {
+    for (size_t stop = 0; stop < stops_.size(); ++stop) {
+      if (!marked[stop]) {
+        continue;
+      }
+      marked[stop] = false;
+      for (const auto& [line, position] : stop_lines_[stop]) {
+        auto& first_position = lines_to_scan[line];
+        if (!first_position || position < *first_position) {
+          first_position = position;
+        }
+      }
+    }
+
+    rounds.emplace_back(stops_.size());
+    const Round& previous = rounds[rounds.size() - 2];
+    Round& current = rounds.back();
+    for (size_t line = 0; line < lines_.size(); ++line) {
+      if (lines_to_scan[line]) {
+        ScanLine(line, *lines_to_scan[line], previous, current, best_times, marked, target, max_time);
+        lines_to_scan[line].reset();
+      }
+    }
+    has_marked = std::find(marked.begin(), marked.end(), true) != marked.end();
+  }
+  return rounds;
+}
+
+void RaptorRouter::ScanLine(size_t line_id, size_t first_position, const Round& previous, Round& current,
+                            std::vector<std::optional<Minutes>>& best_times, std::vector<bool>& marked,
+                            std::optional<size_t> target, std::optional<Minutes> max_time) const {
+  const Line& line = lines_[line_id];
+  const Minutes wait_time(settings_.bus_wait_time.count());
+  std::optional<size_t> board;
+
+  for (size_t position = first_position; position < line.stops.size(); ++position) {
+    const size_t stop = line.stops[position];
+    const auto& previous_label = previous[stop];
+
+    if (board) {
+      const Minutes arrival_time = (previous[line.stops[*board]]->time + wait_time)
+        + ComputeRideTime(line, *board, position);
+      const bool improves_stop = !best_times[stop] || arrival_time < *best_times[stop];
+      const bool improves_target = !target || !best_times[*target] || arrival_time < *best_times[*target];
+      const bool within_time = !max_time || arrival_time <= *max_time;
+      if (improves_stop && improves_target && within_time) {
+        current[stop] = Label{arrival_time, line_id, *board, position};
+        best_times[stop] = arrival_time;
+        marked[stop] = true;
+      }
+    }
+
+    // Пересесть на этот же автобус выгоднее, если сюда можно добраться раньше, чем на нём
+    if (previous_label && (!board
+        || previous_label->time < previous[line.stops[*board]]->time + ComputeRideTime(line, *board, position))) {
+      board = position;
+    }
+  }
+}
+
+std::optional<size_t> RaptorRouter::FindLastRound(const std::vector<Round>& rounds, size_t target) {
+  // Метка ставится, только если улучшает время прибытия, поэтому
+  // последний раунд с меткой в target содержит лучший маршрут
+  for (size_t round = rounds.size(); round > 0; --round) {
+    if (rounds[round - 1][target]) {
+      return round - 1;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<RouteInfo> RaptorRouter::BuildRouteInfo(const std::vector<Round>& rounds, size_t target) const {
+  const auto last_round = FindLastRound(rounds, target);
+  if (!last_round) {
+    return std::nullopt;
+  }
+  size_t round = *last_round;
+
+  RouteInfo route_info;
+  route_info.total_time = rounds[round][target]->time;
+  route_info.items.reserve(round * 2);
+
+  const Minutes wait_time(settings_.bus_wait_time.count());
+  for (size_t stop = target; round > 0; --round) {
+    const Label& label = *rounds[round][stop];
+    const Line& line = lines_[label.line];
+    route_info.items.emplace_back(RouteInfo::BusItem{
+      line.bus,
+      ComputeRideTime(line, label.board, label.alight),
+      label.alight - label.board,
+    });
+    stop = line.stops[label.board];
+    route_info.items.emplace_back(RouteInfo::WaitItem{stops_[stop], wait_time});
+  }
+  std::reverse(route_info.items.begin(), route_info.items.end());
+  return route_info;
+}
+
+}  // namespace tc::router
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "domain.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <optional>
+#include <vector>
+
+namespace tc::router {
+
+// Поиск маршрута по раундам (RAPTOR) прямо по маршрутам автобусов, без графа.
+// Раунд k находит лучшие времена прибытия на остановки ровно с k посадками
+class RaptorRouter {
+public:
+  RaptorRouter(RoutingSettings settings, const TransportCatalogue& catalogue);
+
+  // Время поездки считается по расстояниям при запросе, поэтому достаточно заменить настройки
+  void ApplySettings(const RoutingSettings& settings);
+
+  std::optional<RouteInfo> FindRoute(const Stop* from, const Stop* to) const;
+  std::vector<std::optional<RouteInfo>> FindRoutes(const Stop* from, const std::vector<const Stop*>& to) const;
+  std::vector<std::optional<Minutes>> ComputeTravelTimes(const Stop* from, const std::vector<const Stop*>& to) const;
+  std::vector<ReachableStop> FindReachableStops(const Stop* from, Minutes max_time) const;
+
+private:
+  struct Line {
+    const Bus* bus;
+    std::vector<size_t> stops;
+    // Расстояние от начала маршрута до каждой его остановки: время поездки между
+    // позициями i < j считается по разности расстояний так же, как вес ребра в графе
+    std::vector<size_t> distances;
+  };
+
+  struct LinePosition {
+    size_t line;
+    size_t position;
+  };
+
+  // Лучшее прибытие на остановку в раунде: на автобусе line от позиции board до alight
+  struct Label {
+    Minutes time;
+    size_t line = 0;
+    size_t board = 0;
+    size_t alight = 0;
+  };
+  using Round = std::vector<std::optional<Label>>;
+
+  Minutes ComputeRideTime(const Line& line, size_t board, size_t alight) const;
+  // Раунды поиска из source. Если задан target, отсекаются прибытия не раньше, чем в target,
+  // если задан max_time - прибытия позже max_time
+  std::vector<Round> ComputeRounds(size_t source, std::optional<size_t> target,
+                                   std::optional<Minutes> max_time = std::nullopt) const;
+  void ScanLine(size_t line_id, size_t first_position, const Round& previous, Round& current,
+                std::vector<std::optional<Minutes>>& best_times, std::vector<bool>& marked,
+                std::optional<size_t> target, std::optional<Minutes> max_time) const;
+  std::optional<RouteInfo> BuildRouteInfo(const std::vector<Round>& rounds, size_t target) const;
+  // Последний раунд, в котором есть метка target
+  static std::optional<size_t> FindLastRound(const std::vector<Round>& rounds, size_t target);
+
+  RoutingSettings settings_;
+  std::vector<const Stop*> stops_;  // По номеру остановки
+  std::vector<Line> lines_;
+  std::vector<std::vector<LinePosition>> stop_lines_;
+};
+
+}  // namespace tc::router
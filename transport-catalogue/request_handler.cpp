@@ -18,20 +18,96 @@ const tc::Buses* RequestHandler::GetBusesToStop(std::string_view stop_name) cons
     return stop ? &(catalogue_.GetBusesToStop(stop)) : nullptr;;
 }
 
+const tc::Stop* RequestHandler::GetStop(std::string_view stop_name) const {
+    return catalogue_.GetStop(stop_name);
+}
+
+std::vector<const tc::Bus*> RequestHandler::GetSortedBusesToStop(const tc::Stop* stop) const {
+    if (!catalogue_.IsFrozen()) {
+        const tc::Buses& buses = catalogue_.GetBusesToStop(stop);
+        return {buses.begin(), buses.end()};
+    }
+    std::vector<const tc::Bus*> buses;
+    for (const tc::BusId bus_id : catalogue_.GetBusIdsToStop(stop)) {
+        buses.push_back(catalogue_.GetBusById(bus_id));
+    }
+    return buses;
+}
+
 svg::Document RequestHandler::RenderMap() const {
     return renderer_.GetSVG(catalogue_.GetSortedAllBuses());
 }
 
-std::optional<tc::router::RouteInfo> RequestHandler::FindRoute(std::string_view stop_name_from,
-  std::string_view stop_name_to) const {
+const tc::router::RouteInfo* RequestHandler::FindRoute(std::string_view stop_name_from,
+  std::string_view stop_name_to, std::string_view profile) const {
   const tc::Stop *from = catalogue_.GetStop(stop_name_from);
   const tc::Stop *to = catalogue_.GetStop(stop_name_to);
+  const tc::router::TransportRouter *router = profiles_.GetProfile(profile);
 
-  if (from != nullptr && to != nullptr) {
-    return router_.FindRoute(from, to);
+  if (from != nullptr && to != nullptr && router != nullptr) {
+    return router->FindRoute(from, to, tc::router::TransportRouter::GetThreadQueryContext());
   } else {
+    return nullptr;
+  }
+}
+
+std::vector<const tc::router::RouteInfo*> RequestHandler::FindRoutes(std::string_view stop_name_from,
+  const std::vector<std::string_view>& stop_names_to, std::string_view profile) const {
+  std::vector<const tc::router::RouteInfo*> routes(stop_names_to.size(), nullptr);
+  const tc::Stop *from = catalogue_.GetStop(stop_name_from);
+  const tc::router::TransportRouter *router = profiles_.GetProfile(profile);
+  if (from == nullptr || router == nullptr) {
+    return routes;
+  }
+
+  std::vector<const tc::Stop*> stops_to;
+  std::vector<size_t> positions;
+  for (size_t i = 0; i < stop_names_to.size(); ++i) {
+    if (const tc::Stop *to = catalogue_.GetStop(stop_names_to[i])) {
+      stops_to.push_back(to);
+      positions.push_back(i);
+    }
+  }
+  const auto& found_routes = router->FindRoutes(from, stops_to, tc::router::TransportRouter::GetThreadQueryContext());
+  for (size_t i = 0; i < positions.size(); ++i) {
+    routes[positions[i]] = found_routes[i];
+  }
+  return routes;
+}
+
+std::optional<std::vector<std::optional<tc::router::Minutes>>> RequestHandler::ComputeTravelTimes(
+  const std::vector<std::string_view>& stop_names_from, const std::vector<std::string_view>& stop_names_to,
+  std::string_view profile) const {
+  const tc::router::TransportRouter *router = profiles_.GetProfile(profile);
+  if (router == nullptr) {
+    return std::nullopt;
+  }
+  auto find_stops = [this](const std::vector<std::string_view>& stop_names) {
+    std::vector<const tc::Stop*> stops;
+    stops.reserve(stop_names.size());
+    for (const auto stop_name : stop_names) {
+      if (const tc::Stop *stop = catalogue_.GetStop(stop_name)) {
+        stops.push_back(stop);
+      }
+    }
+    return stops;
+  };
+  const auto stops_from = find_stops(stop_names_from);
+  const auto stops_to = find_stops(stop_names_to);
+  if (stops_from.size() != stop_names_from.size() || stops_to.size() != stop_names_to.size()) {
+    return std::nullopt;
+  }
+  return router->ComputeTravelTimes(stops_from, stops_to);
+}
+
+std::optional<std::vector<tc::router::ReachableStop>> RequestHandler::FindReachableStops(
+  std::string_view stop_name_from, tc::router::Minutes max_time, std::string_view profile) const {
+  const tc::Stop *from = catalogue_.GetStop(stop_name_from);
+  const tc::router::TransportRouter *router = profiles_.GetProfile(profile);
+  if (from == nullptr || router == nullptr) {
     return std::nullopt;
   }
+  return router->FindReachableStops(from, max_time);
 }
 
 const tc::BusInfo RequestHandler::GetBusStat(std::string_view bus_name) const {
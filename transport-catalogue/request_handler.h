@@ -7,17 +7,36 @@
  
 class RequestHandler {
 public:
-    explicit RequestHandler(tc::TransportCatalogue& catalogue, const renderer::MapRenderer& renderer, const tc::router::TransportRouter& router)
+    explicit RequestHandler(tc::TransportCatalogue& catalogue, const renderer::MapRenderer& renderer, const tc::router::RoutingProfiles& profiles)
         : renderer_(renderer)
         , catalogue_(catalogue)
-        , router_(router)
+        , profiles_(profiles)
     {
     }
     const tc::Buses* GetBusesToStop(std::string_view stop_name) const ;
+    const tc::Stop* GetStop(std::string_view stop_name) const;
+    // Автобусы через остановку по возрастанию названия
+    std::vector<const tc::Bus*> GetSortedBusesToStop(const tc::Stop* stop) const;
     bool IsBusNumber(const std::string_view bus_number) const ;
     bool IsStopName(const std::string_view stop_name) const;
     const tc::BusInfo GetBusStat(std::string_view bus_name) const;
-    std::optional<tc::router::RouteInfo> FindRoute(std::string_view stop_name_from, std::string_view stop_name_to) const;
+    // Запросы к маршрутизатору идут в профиль profile (пустое имя - основной профиль).
+    // Неизвестный профиль отвечает так же, как неизвестная остановка.
+    // Маршруты лежат в контексте запросов текущего потока и действительны до следующего
+    // запроса маршрута в этом потоке; nullptr, если маршрута нет
+    const tc::router::RouteInfo* FindRoute(std::string_view stop_name_from, std::string_view stop_name_to,
+                                           std::string_view profile = {}) const;
+    std::vector<const tc::router::RouteInfo*> FindRoutes(std::string_view stop_name_from,
+                                                         const std::vector<std::string_view>& stop_names_to,
+                                                         std::string_view profile = {}) const;
+    // Матрица времени в пути по строкам; nullopt, если какой-то остановки нет в справочнике
+    std::optional<std::vector<std::optional<tc::router::Minutes>>> ComputeTravelTimes(
+        const std::vector<std::string_view>& stop_names_from, const std::vector<std::string_view>& stop_names_to,
+        std::string_view profile = {}) const;
+    // Остановки, достижимые за max_time; nullopt, если остановки нет в справочнике
+    std::optional<std::vector<tc::router::ReachableStop>> FindReachableStops(std::string_view stop_name_from,
+                                                                             tc::router::Minutes max_time,
+                                                                             std::string_view profile = {}) const;
     
     svg::Document RenderMap() const;
      
@@ -25,5 +44,5 @@ public:
 private:
     const renderer::MapRenderer& renderer_;
     const tc::TransportCatalogue& catalogue_;
-    const tc::router::TransportRouter& router_;
+    const tc::router::RoutingProfiles& profiles_;
 };
@@ -1,26 +1,79 @@
 #pragma once
 
 #include "graph.h"
+#include "min_plus.h"
+#include "query_context.h"
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <iterator>
+#include <limits>
+#include <mutex>
 #include <optional>
+#include <ostream>
 #include <stdexcept>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace graph {
 
+// Представление веса ребра числом для плоских таблиц маршрутизатора
 template <typename Weight>
+struct WeightTraits {
+    using Rep = Weight;
+
+    static Rep ToRep(Weight weight) {
+        return weight;
+    }
+    static Weight FromRep(Rep rep) {
+        return rep;
+    }
+};
+
+template <typename Rep_, typename Period>
+struct WeightTraits<std::chrono::duration<Rep_, Period>> {
+    using Rep = Rep_;
+
+    static Rep ToRep(std::chrono::duration<Rep, Period> weight) {
+        return weight.count();
+    }
+    static std::chrono::duration<Rep, Period> FromRep(Rep rep) {
+        return std::chrono::duration<Rep, Period>(rep);
+    }
+};
+
+// WeightRep - тип, в котором хранятся веса таблицы маршрутов.
+// Например, float вместо double сокращает таблицу ещё на треть ценой точности
+template <typename Weight, typename WeightRep = typename WeightTraits<Weight>::Rep>
 class Router {
 private:
     using Graph = DirectedWeightedGraph<Weight>;
+    using Traits = WeightTraits<Weight>;
 
 public:
-    explicit Router(const Graph& graph);
+    using PrevEdge = uint32_t;
+
+    // Плоская таблица маршрутов vertex_count x vertex_count
+    struct RoutesTable {
+        const WeightRep* weights;
+        const PrevEdge* prev_edges;
+    };
+
+    // thread_count задаёт число потоков для предподсчёта таблицы маршрутов
+    explicit Router(const Graph& graph, size_t thread_count = 1);
+    // Маршрутизатор над готовой таблицей без копирования, например отображённой из файла.
+    // Таблица должна жить дольше маршрутизатора. table_size - длина каждого из массивов таблицы,
+    // если она не vertex_count x vertex_count, бросается std::invalid_argument
+    Router(const Graph& graph, RoutesTable routes_table, size_t table_size);
+
+    RoutesTable GetRoutesTable() const {
+        return {weights_, prev_edges_};
+    }
 
     struct RouteInfo {
         Weight weight;
@@ -28,90 +81,248 @@ public:
     };
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    // Вес маршрута, рёбра маршрута - в context.GetRouteEdges(), без выделения памяти
+    // после того, как буфер рёбер контекста дорос до длины маршрута
+    std::optional<Weight> BuildRoute(VertexId from, VertexId to, QueryContext<Weight>& context) const;
+
+    std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const {
+        if (from >= vertex_count_ || to >= vertex_count_) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        const WeightRep weight = weights_[GetIndex(from, to)];
+        if (weight == INFINITE_WEIGHT) {
+            return std::nullopt;
+        }
+        return Traits::FromRep(weight);
+    }
+
+    // Размер таблицы маршрутов в байтах для графа с vertex_count вершинами
+    static size_t GetRoutesTableSize(size_t vertex_count) {
+        return vertex_count * vertex_count * (sizeof(WeightRep) + sizeof(PrevEdge));
+    }
+
+    static void PrintMemoryReport(std::ostream& out, size_t vertex_count);
 
 private:
-    struct RouteInternalData {
-        Weight weight;
-        std::optional<EdgeId> prev_edge;
-    };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+    // Таблица хранится построчно в двух плоских массивах: веса маршрутов и последние рёбра.
+    // Недостижимость кодируется бесконечным весом, пустой маршрут - значением NO_EDGE
+    static constexpr PrevEdge NO_EDGE = min_plus::NO_EDGE;
+    static constexpr WeightRep INFINITE_WEIGHT = std::numeric_limits<WeightRep>::has_infinity
+        ? std::numeric_limits<WeightRep>::infinity()
+        : std::numeric_limits<WeightRep>::max();
+    static constexpr WeightRep ZERO_WEIGHT{};
+    static constexpr size_t COLUMN_BLOCK_SIZE = 2048;
+
+    size_t GetIndex(VertexId from, VertexId to) const {
+        return from * vertex_count_ + to;
+    }
+
+    // Рёбра маршрута из from в to по таблице, маршрут должен существовать.
+    // Внешняя таблица не проверяется целиком, поэтому ребро вне графа или маршрут
+    // длиннее числа вершин (цикл) - повреждённая таблица: бросается std::runtime_error
+    void ExtractRouteEdges(VertexId from, VertexId to, std::vector<EdgeId>& edges) const;
 
     void InitializeRoutesInternalData(const Graph& graph) {
-        const size_t vertex_count = graph.GetVertexCount();
-        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-            routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+        if (graph.GetEdgeCount() >= NO_EDGE) {
+            throw std::length_error("Too many edges for the routes table");
+        }
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            owned_weights_[GetIndex(vertex, vertex)] = ZERO_WEIGHT;
             for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
                 const auto& edge = graph.GetEdge(edge_id);
-                if (edge.weight < ZERO_WEIGHT) {
+                const WeightRep edge_weight = static_cast<WeightRep>(Traits::ToRep(edge.weight));
+                if (edge_weight < ZERO_WEIGHT) {
                     throw std::domain_error("Edges' weights should be non-negative");
                 }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{edge.weight, edge_id};
+                const size_t index = GetIndex(vertex, edge.to);
+                if (edge_weight < owned_weights_[index]) {
+                    owned_weights_[index] = edge_weight;
+                    owned_prev_edges_[index] = static_cast<PrevEdge>(edge_id);
                 }
             }
         }
     }
 
-    void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-                    const RouteInternalData& route_to) {
-        auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-        const Weight candidate_weight = route_from.weight + route_to.weight;
-        if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-            route_relaxing = {candidate_weight,
-                              route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+    // Столбцы обходятся блоками, чтобы отрезок строки vertex_through оставался в кэше,
+    // пока через него релаксируются все строки. Порядок релаксаций внутри шага
+    // на результат не влияет
+    void RelaxRoutesInternalDataThroughVertex(VertexId vertex_from_begin, VertexId vertex_from_end,
+                                              VertexId vertex_through) {
+        const WeightRep* weights_through = &owned_weights_[GetIndex(vertex_through, 0)];
+        const PrevEdge* prev_edges_through = &owned_prev_edges_[GetIndex(vertex_through, 0)];
+        for (VertexId column_begin = 0; column_begin < vertex_count_; column_begin += COLUMN_BLOCK_SIZE) {
+            const size_t column_count = std::min(COLUMN_BLOCK_SIZE, vertex_count_ - column_begin);
+            for (VertexId vertex_from = vertex_from_begin; vertex_from < vertex_from_end; ++vertex_from) {
+                const size_t index_through = GetIndex(vertex_from, vertex_through);
+                // Маршрут через саму вершину vertex_through короче не станет
+                if (vertex_from == vertex_through || owned_weights_[index_through] == INFINITE_WEIGHT) {
+                    continue;
+                }
+                const size_t index_begin = GetIndex(vertex_from, column_begin);
+                min_plus::RelaxRow(owned_weights_[index_through], owned_prev_edges_[index_through],
+                                   weights_through + column_begin, prev_edges_through + column_begin,
+                                   &owned_weights_[index_begin], &owned_prev_edges_[index_begin], column_count);
+            }
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
-                    }
-                }
+    // Строки таблицы делятся между потоками. На шаге vertex_through строка и столбец
+    // vertex_through не меняются, поэтому потокам достаточно синхронизироваться между шагами,
+    // а результат совпадает с однопоточным
+    void RelaxRoutesInternalDataInParallel(size_t thread_count) {
+        Barrier barrier(thread_count);
+        auto relax_rows = [this, thread_count, &barrier](size_t thread_index) {
+            const VertexId vertex_from_begin = vertex_count_ * thread_index / thread_count;
+            const VertexId vertex_from_end = vertex_count_ * (thread_index + 1) / thread_count;
+            for (VertexId vertex_through = 0; vertex_through < vertex_count_; ++vertex_through) {
+                RelaxRoutesInternalDataThroughVertex(vertex_from_begin, vertex_from_end, vertex_through);
+                barrier.ArriveAndWait();
             }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(thread_count - 1);
+        for (size_t thread_index = 1; thread_index < thread_count; ++thread_index) {
+            workers.emplace_back(relax_rows, thread_index);
+        }
+        relax_rows(0);
+        for (auto& worker : workers) {
+            worker.join();
         }
     }
 
-    static constexpr Weight ZERO_WEIGHT{};
+    class Barrier {
+    public:
+        explicit Barrier(size_t thread_count)
+            : thread_count_(thread_count) {
+        }
+
+        void ArriveAndWait() {
+            std::unique_lock lock(mutex_);
+            const size_t generation = generation_;
+            if (++arrived_ == thread_count_) {
+                arrived_ = 0;
+                ++generation_;
+                condition_.notify_all();
+            } else {
+                condition_.wait(lock, [this, generation] { return generation != generation_; });
+            }
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        const size_t thread_count_;
+        size_t arrived_ = 0;
+        size_t generation_ = 0;
+    };
+
     const Graph& graph_;
-    RoutesInternalData routes_internal_data_;
+    const size_t vertex_count_;
+    // Таблица, посчитанная в конструкторе. У маршрутизатора над внешней таблицей пуста
+    std::vector<WeightRep> owned_weights_;
+    std::vector<PrevEdge> owned_prev_edges_;
+    // Запросы читают таблицу через эти указатели
+    const WeightRep* weights_ = nullptr;
+    const PrevEdge* prev_edges_ = nullptr;
 };
 
-template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+template <typename Weight, typename WeightRep>
+Router<Weight, WeightRep>::Router(const Graph& graph, size_t thread_count)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    , vertex_count_(graph.GetVertexCount())
+    , owned_weights_(vertex_count_ * vertex_count_, INFINITE_WEIGHT)
+    , owned_prev_edges_(vertex_count_ * vertex_count_, NO_EDGE)
+    , weights_(owned_weights_.data())
+    , prev_edges_(owned_prev_edges_.data())
 {
     InitializeRoutesInternalData(graph);
 
-    const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+    thread_count = std::clamp<size_t>(thread_count, 1, std::max<size_t>(vertex_count_, 1));
+    if (thread_count > 1) {
+        RelaxRoutesInternalDataInParallel(thread_count);
+        return;
+    }
+    for (VertexId vertex_through = 0; vertex_through < vertex_count_; ++vertex_through) {
+        RelaxRoutesInternalDataThroughVertex(0, vertex_count_, vertex_through);
     }
 }
 
-template <typename Weight>
-std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
-                                                                             VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    if (!route_internal_data) {
+template <typename Weight, typename WeightRep>
+Router<Weight, WeightRep>::Router(const Graph& graph, RoutesTable routes_table, size_t table_size)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+    , weights_(routes_table.weights)
+    , prev_edges_(routes_table.prev_edges)
+{
+    const bool is_square = vertex_count_ == 0
+        ? table_size == 0
+        : table_size % vertex_count_ == 0 && table_size / vertex_count_ == vertex_count_;
+    if (!is_square) {
+        throw std::invalid_argument("Routes table doesn't match the graph");
+    }
+}
+
+template <typename Weight, typename WeightRep>
+std::optional<typename Router<Weight, WeightRep>::RouteInfo>
+Router<Weight, WeightRep>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const size_t index = GetIndex(from, to);
+    if (weights_[index] == INFINITE_WEIGHT) {
         return std::nullopt;
     }
-    const Weight weight = route_internal_data->weight;
+    const Weight weight = Traits::FromRep(weights_[index]);
     std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-         edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+    ExtractRouteEdges(from, to, edges);
+
+    return RouteInfo{weight, std::move(edges)};
+}
+
+template <typename Weight, typename WeightRep>
+std::optional<Weight>
+Router<Weight, WeightRep>::BuildRoute(VertexId from, VertexId to, QueryContext<Weight>& context) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const size_t index = GetIndex(from, to);
+    if (weights_[index] == INFINITE_WEIGHT) {
+        return std::nullopt;
+    }
+    ExtractRouteEdges(from, to, context.GetRouteEdges());
+    return Traits::FromRep(weights_[index]);
+}
+
+template <typename Weight, typename WeightRep>
+void Router<Weight, WeightRep>::ExtractRouteEdges(VertexId from, VertexId to, std::vector<EdgeId>& edges) const {
+    edges.clear();
+    for (PrevEdge edge_id = prev_edges_[GetIndex(from, to)];
+         edge_id != NO_EDGE;
+         edge_id = prev_edges_[GetIndex(from, graph_.GetEdge(edge_id).from)])
     {
-        edges.push_back(*edge_id);
+        if (edge_id >= graph_.GetEdgeCount() || edges.size() >= vertex_count_) {
+            throw std::runtime_error("Routes table is corrupt");
+        }
+        edges.push_back(edge_id);
     }
     std::reverse(edges.begin(), edges.end());
+}
 
-    return RouteInfo{weight, std::move(edges)};
+template <typename Weight, typename WeightRep>
+void Router<Weight, WeightRep>::PrintMemoryReport(std::ostream& out, size_t vertex_count) {
+    // Прежняя раскладка: строка vector<optional<RouteInternalData>> на каждую вершину
+    struct LegacyRouteInternalData {
+        Weight weight;
+        std::optional<EdgeId> prev_edge;
+    };
+    const size_t legacy_size = vertex_count * sizeof(std::vector<std::optional<LegacyRouteInternalData>>)
+        + vertex_count * vertex_count * sizeof(std::optional<LegacyRouteInternalData>);
+    const size_t compact_size = GetRoutesTableSize(vertex_count);
+
+    out << "Routes table for " << vertex_count << " vertices: "
+        << compact_size << " bytes (" << sizeof(WeightRep) + sizeof(PrevEdge) << " bytes per route), "
+        << "legacy layout: " << legacy_size << " bytes" << std::endl;
 }
 
 }  // namespace graph
\ No newline at end of file
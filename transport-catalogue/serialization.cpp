@@ -0,0 +1,234 @@
+#include "serialization.h"
+
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SNAPSHOT_USE_MMAP
+#endif
+
+namespace serialization {
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'T', 'C', 'S', 'N', 'A', 'P', 'S', 'H'};
+// Снимок читается на месте, поэтому порядок байт и размеры типов должны совпадать с записавшей машиной
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order_mark;
+    uint32_t size_t_size;
+    uint32_t double_size;
+};
+
+SnapshotHeader MakeHeader() {
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order_mark = BYTE_ORDER_MARK;
+    header.size_t_size = sizeof(size_t);
+    header.double_size = sizeof(double);
+    return header;
+}
+
+struct DistanceRecord {
+    uint32_t from;
+    uint32_t to;
+    int32_t distance;
+};
+
+}  // namespace
+
+SnapshotWriter::SnapshotWriter(std::ostream& output)
+    : output_(output) {
+    WriteValue(MakeHeader());
+}
+
+void SnapshotWriter::WriteString(std::string_view value) {
+    WriteValue<uint64_t>(value.size());
+    WriteBytes(value.data(), value.size());
+}
+
+void SnapshotWriter::WriteBytes(const void* data, size_t size) {
+    output_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    offset_ += size;
+}
+
+void SnapshotWriter::WritePadding() {
+    static const char ZEROS[ARRAY_ALIGNMENT] = {};
+    WriteBytes(ZEROS, (ARRAY_ALIGNMENT - offset_ % ARRAY_ALIGNMENT) % ARRAY_ALIGNMENT);
+}
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef SNAPSHOT_USE_MMAP
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Can't open snapshot " + path);
+    }
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+        void* data = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            data_ = static_cast<const char*>(data);
+            size_ = static_cast<size_t>(file_stat.st_size);
+        }
+    }
+    close(fd);
+    if (data_) {
+        return;
+    }
+#endif
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("Can't open snapshot " + path);
+    }
+    buffer_.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile() {
+#ifdef SNAPSHOT_USE_MMAP
+    if (buffer_.empty() && data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+const char* MappedFile::GetData() const {
+    return data_;
+}
+
+size_t MappedFile::GetSize() const {
+    return size_;
+}
+
+SnapshotReader::SnapshotReader(const std::string& path)
+    : file_(std::make_shared<MappedFile>(path)) {
+    if (file_->GetSize() < sizeof(SnapshotHeader)) {
+        throw std::runtime_error("Not a transport catalogue snapshot");
+    }
+    const auto header = ReadValue<SnapshotHeader>();
+    const auto expected = MakeHeader();
+    if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a transport catalogue snapshot");
+    }
+    if (header.version != expected.version) {
+        throw std::runtime_error("Unsupported snapshot version " + std::to_string(header.version));
+    }
+    if (header.byte_order_mark != expected.byte_order_mark || header.size_t_size != expected.size_t_size
+        || header.double_size != expected.double_size) {
+        throw std::runtime_error("Snapshot was written on an incompatible platform");
+    }
+}
+
+std::string_view SnapshotReader::ReadString() {
+    const size_t size = ReadValue<uint64_t>();
+    return {ReadBytes(size), size};
+}
+
+bool SnapshotReader::ReadBool() {
+    static_assert(sizeof(bool) == sizeof(uint8_t));
+    const auto value = ReadValue<uint8_t>();
+    CheckIntegrity(value <= 1);
+    return value == 1;
+}
+
+std::shared_ptr<const MappedFile> SnapshotReader::GetFile() const {
+    return file_;
+}
+
+const char* SnapshotReader::ReadBytes(size_t size) {
+    if (size > file_->GetSize() - offset_) {
+        throw std::runtime_error("Snapshot is truncated");
+    }
+    const char* data = file_->GetData() + offset_;
+    offset_ += size;
+    return data;
+}
+
+size_t SnapshotReader::GetRemainingSize() const {
+    return file_->GetSize() - offset_;
+}
+
+void SnapshotReader::SkipPadding() {
+    ReadBytes((ARRAY_ALIGNMENT - offset_ % ARRAY_ALIGNMENT) % ARRAY_ALIGNMENT);
+}
+
+void CheckIntegrity(bool is_consistent) {
+    if (!is_consistent) {
+        throw std::runtime_error("Snapshot is corrupt");
+    }
+}
+
+// Остановки и автобусы пишутся в порядке справочника, и ссылки на них - это их номера
+void SaveCatalogue(SnapshotWriter& writer, const tc::TransportCatalogue& catalogue) {
+    const auto& stops = catalogue.GetStops();
+    writer.WriteValue<uint64_t>(stops.size());
+    for (const auto& stop : stops) {
+        writer.WriteString(stop.name_);
+        writer.WriteValue(stop.coordinates_);
+    }
+
+    std::vector<DistanceRecord> distances;
+    distances.reserve(catalogue.GetDistances().size());
+    for (const auto& [stops_pair, distance] : catalogue.GetDistances()) {
+        distances.push_back({stops_pair.first, stops_pair.second, distance});
+    }
+    writer.WriteArray(distances);
+
+    const auto& buses = catalogue.GetBuses();
+    writer.WriteValue<uint64_t>(buses.size());
+    for (const auto& bus : buses) {
+        writer.WriteString(bus.name_);
+        writer.WriteValue(bus.is_circle_);
+        std::vector<uint32_t> bus_stops;
+        bus_stops.reserve(bus.stops_.size());
+        for (const tc::Stop* stop : bus.stops_) {
+            bus_stops.push_back(stop->id_);
+        }
+        writer.WriteArray(bus_stops);
+    }
+}
+
+void LoadCatalogue(SnapshotReader& reader, tc::TransportCatalogue& catalogue) {
+    // Остановка занимает в файле хотя бы длину названия и координаты
+    const size_t stop_count = reader.ReadValue<uint64_t>();
+    CheckIntegrity(stop_count <= reader.GetRemainingSize() / (sizeof(uint64_t) + sizeof(geo::Coordinates)));
+    std::vector<tc::Stop*> stops;
+    stops.reserve(stop_count);
+    for (size_t i = 0; i < stop_count; ++i) {
+        const std::string_view name = reader.ReadString();
+        const auto coordinates = reader.ReadValue<geo::Coordinates>();
+        catalogue.AddStop(tc::Stop(name, coordinates));
+        stops.push_back(catalogue.GetStop(name));
+    }
+
+    for (const auto& record : reader.ReadArray<DistanceRecord>()) {
+        CheckIntegrity(record.from < stops.size() && record.to < stops.size());
+        catalogue.SetDistance(stops[record.from], stops[record.to], record.distance);
+    }
+
+    // Автобус - хотя бы длина названия, признак кольца и длина массива остановок
+    const size_t bus_count = reader.ReadValue<uint64_t>();
+    CheckIntegrity(bus_count <= reader.GetRemainingSize() / (2 * sizeof(uint64_t) + sizeof(bool)));
+    for (size_t i = 0; i < bus_count; ++i) {
+        const std::string_view name = reader.ReadString();
+        const bool is_circle = reader.ReadBool();
+        tc::Route route;
+        for (const uint32_t stop : reader.ReadArray<uint32_t>()) {
+            CheckIntegrity(stop < stops.size());
+            route.push_back(stops[stop]);
+        }
+        catalogue.AddBus(tc::Bus(name, std::move(route), is_circle));
+    }
+    catalogue.Freeze();
+}
+
+}  // namespace serialization
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "ranges.h"
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace serialization {
+
+// Снимок - последовательность значений и массивов в порядке записи, без схемы.
+// Массивы выровнены по ARRAY_ALIGNMENT от начала файла, поэтому при отображении
+// файла в память их можно читать на месте, без копирования.
+// Номер версии меняется при любом изменении того, что и в каком порядке пишется
+inline constexpr uint32_t SNAPSHOT_VERSION = 4;
+inline constexpr size_t ARRAY_ALIGNMENT = 64;
+
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(std::ostream& output);
+
+    template <typename T>
+    void WriteValue(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        WriteBytes(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void WriteArray(const T* data, size_t size) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        WriteValue<uint64_t>(size);
+        WritePadding();
+        WriteBytes(data, size * sizeof(T));
+    }
+
+    template <typename T>
+    void WriteArray(const std::vector<T>& values) {
+        WriteArray(values.data(), values.size());
+    }
+
+    void WriteString(std::string_view value);
+
+private:
+    void WriteBytes(const void* data, size_t size);
+    void WritePadding();
+
+    std::ostream& output_;
+    size_t offset_ = 0;
+};
+
+// Файл снимка целиком в памяти: отображённый (mmap), где это возможно, или прочитанный
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    const char* GetData() const;
+    size_t GetSize() const;
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<char> buffer_;  // Если отобразить файл не удалось
+};
+
+class SnapshotReader {
+public:
+    // Бросает std::runtime_error, если файл не снимок или снимок другой версии
+    explicit SnapshotReader(const std::string& path);
+
+    template <typename T>
+    T ReadValue() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, ReadBytes(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    // Бросает std::runtime_error, если байт - не 0 и не 1
+    bool ReadBool();
+
+    // Массив читается на месте и живёт, пока жив файл (GetFile)
+    template <typename T>
+    ranges::Range<const T*> ReadArray() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const uint64_t size = ReadValue<uint64_t>();
+        SkipPadding();
+        // Размер из файла может быть любым: произведение size * sizeof(T) не должно переполниться
+        if (size > GetRemainingSize() / sizeof(T)) {
+            throw std::runtime_error("Snapshot is truncated");
+        }
+        const T* data = reinterpret_cast<const T*>(ReadBytes(size * sizeof(T)));
+        return {data, data + size};
+    }
+
+    template <typename T>
+    std::vector<T> ReadVector() {
+        const auto values = ReadArray<T>();
+        return {values.begin(), values.end()};
+    }
+
+    std::string_view ReadString();
+
+    std::shared_ptr<const MappedFile> GetFile() const;
+    // Сколько байт осталось непрочитанными: по нему проверяются прочитанные из файла количества
+    size_t GetRemainingSize() const;
+
+private:
+    const char* ReadBytes(size_t size);
+    void SkipPadding();
+
+    std::shared_ptr<const MappedFile> file_;
+    size_t offset_ = 0;
+};
+
+// Бросает std::runtime_error, если прочитанные из снимка данные не согласованы между собой
+void CheckIntegrity(bool is_consistent);
+
+void SaveCatalogue(SnapshotWriter& writer, const tc::TransportCatalogue& catalogue);
+void LoadCatalogue(SnapshotReader& reader, tc::TransportCatalogue& catalogue);
+
+}  // namespace serialization
@@ -0,0 +1,168 @@
+// Запросы маршрутов с контекстом не выделяют память, когда буферы контекста доросли.
+// Трасса запросов прогоняется дважды на синтетической сети: первый проход разогревает
+// контекст, во втором operator new не должен вызываться ни разу.
+// Сборка из каталога transport-catalogue:
+//   g++ -std=c++17 -O2 -pthread -I. tests/query_context_alloc_test.cpp $(ls *.cpp | grep -v '^main.cpp$')
+//       -o query_context_alloc_test
+// Код возврата - EXIT_FAILURE, если во втором проходе была хоть одна аллокация
+
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <cstdlib>
+#include <iterator>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+bool counting = false;
+size_t allocation_count = 0;
+
+void* Allocate(size_t size) {
+    if (counting) {
+        ++allocation_count;
+    }
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    return Allocate(size);
+}
+
+void* operator new[](size_t size) {
+    return Allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+
+using tc::router::TransportRouter;
+
+const size_t GRID_SIZE = 12;
+
+// Сетка GRID_SIZE x GRID_SIZE остановок: по автобусу на каждую строку и каждый столбец
+void FillGrid(tc::TransportCatalogue& catalogue) {
+    for (size_t row = 0; row < GRID_SIZE; ++row) {
+        for (size_t column = 0; column < GRID_SIZE; ++column) {
+            const std::string name = "Stop " + std::to_string(row) + "-" + std::to_string(column);
+            catalogue.AddStop(tc::Stop(name, {55.0 + row * 0.01, 37.0 + column * 0.01}));
+        }
+    }
+    auto stop_at = [&catalogue](size_t row, size_t column) {
+        return catalogue.GetStop("Stop " + std::to_string(row) + "-" + std::to_string(column));
+    };
+    for (size_t line = 0; line < GRID_SIZE; ++line) {
+        tc::Route row_stops;
+        tc::Route column_stops;
+        for (size_t i = 0; i < GRID_SIZE; ++i) {
+            row_stops.push_back(stop_at(line, i));
+            column_stops.push_back(stop_at(i, line));
+        }
+        for (size_t i = 1; i < GRID_SIZE; ++i) {
+            catalogue.SetDistance(row_stops[i - 1], row_stops[i], static_cast<int>(700 + (line * 31 + i * 17) % 600));
+            catalogue.SetDistance(column_stops[i - 1], column_stops[i], static_cast<int>(700 + (line * 13 + i * 29) % 600));
+        }
+        // Некольцевой маршрут хранится туда и обратно, как его раскладывает JsonReader
+        row_stops.insert(row_stops.end(), std::next(row_stops.rbegin()), row_stops.rend());
+        column_stops.insert(column_stops.end(), std::next(column_stops.rbegin()), column_stops.rend());
+        catalogue.AddBus(tc::Bus("R" + std::to_string(line), std::move(row_stops), false));
+        catalogue.AddBus(tc::Bus("C" + std::to_string(line), std::move(column_stops), false));
+    }
+    catalogue.Freeze();
+}
+
+struct Trace {
+    std::vector<std::pair<const tc::Stop*, const tc::Stop*>> routes;
+    std::vector<std::pair<const tc::Stop*, std::vector<const tc::Stop*>>> batches;
+};
+
+Trace MakeTrace(const tc::TransportCatalogue& catalogue) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<tc::StopId> stop_distribution(0, GRID_SIZE * GRID_SIZE - 1);
+    auto random_stop = [&]() {
+        return catalogue.GetStopById(stop_distribution(generator));
+    };
+    Trace trace;
+    for (size_t i = 0; i < 500; ++i) {
+        trace.routes.emplace_back(random_stop(), random_stop());
+    }
+    for (size_t i = 0; i < 50; ++i) {
+        std::vector<const tc::Stop*> to;
+        for (size_t j = 0; j < 1 + i % 8; ++j) {
+            to.push_back(random_stop());
+        }
+        trace.batches.emplace_back(random_stop(), std::move(to));
+    }
+    return trace;
+}
+
+// Возвращает число найденных маршрутов, чтобы запросы нельзя было выбросить
+size_t ReplayTrace(const TransportRouter& router, const Trace& trace, TransportRouter::QueryContext& context) {
+    size_t found = 0;
+    for (const auto& [from, to] : trace.routes) {
+        found += router.FindRoute(from, to, context) != nullptr;
+    }
+    for (const auto& [from, to] : trace.batches) {
+        for (const tc::router::RouteInfo* route : router.FindRoutes(from, to, context)) {
+            found += route != nullptr;
+        }
+    }
+    return found;
+}
+
+bool CheckRouter(const tc::TransportCatalogue& catalogue, const Trace& trace, tc::router::RouterType router_type,
+                 const std::string& name) {
+    tc::router::RoutingSettings settings;
+    settings.bus_wait_time = std::chrono::minutes(6);
+    settings.bus_velocity = 40;
+    settings.router_type = router_type;
+    const TransportRouter router(settings, catalogue);
+
+    TransportRouter::QueryContext context;
+    const size_t warm_found = ReplayTrace(router, trace, context);
+
+    allocation_count = 0;
+    counting = true;
+    const size_t found = ReplayTrace(router, trace, context);
+    counting = false;
+
+    std::cout << name << ": " << found << " routes, " << allocation_count << " allocations" << std::endl;
+    return found == warm_found && allocation_count == 0;
+}
+
+}  // namespace
+
+int main() {
+    tc::TransportCatalogue catalogue;
+    FillGrid(catalogue);
+    const Trace trace = MakeTrace(catalogue);
+
+    bool ok = CheckRouter(catalogue, trace, tc::router::RouterType::ALL_PAIRS, "all_pairs");
+    ok = CheckRouter(catalogue, trace, tc::router::RouterType::DIJKSTRA, "dijkstra") && ok;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
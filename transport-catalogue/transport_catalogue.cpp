@@ -1,29 +1,150 @@
 #include "transport_catalogue.h"
 
 #include <algorithm>
-#include <execution>
 #include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
 
 namespace tc{
 void TransportCatalogue::AddStop(const Stop& stop) {
     stops_.push_back(stop);
+    stops_.back().name_ = names_.Add(stop.name_);
+    stops_.back().id_ = static_cast<StopId>(stops_.size() - 1);
     stopname_to_stop_.insert({stops_.back().name_, &stops_.back()});
+    stop_buses_.emplace_back();
+    Unfreeze();
 }
 
-void TransportCatalogue::AddBus(const Bus& bus) {
-    buses_.push_back(bus);
+void TransportCatalogue::AddBus(Bus bus) {
+    bus.name_ = names_.Add(bus.name_);
+    buses_.push_back(std::move(bus));
+    buses_.back().id_ = static_cast<BusId>(buses_.size() - 1);
     busname_to_bus_.insert({buses_.back().name_, &buses_.back()});
+    const Bus* added_bus = &buses_.back();
+    const auto position = std::upper_bound(sorted_buses_.begin(), sorted_buses_.end(), added_bus,
+                                           [](const Bus* lhs, const Bus* rhs) {
+        return lhs->name_ < rhs->name_;
+    });
+    sorted_buses_.insert(position, added_bus);
     for (const auto& stop : buses_.back().stops_) {
-        stopname_to_buses_[stop->name_].insert(&buses_.back());
+        stop_buses_.at(stop->id_).insert(&buses_.back());
     }
+    Unfreeze();
 }	
 
 void TransportCatalogue::SetDistance(const Stop* first, const Stop* second, int distance) {
-    auto pair_distance = std::make_pair(first, second);
+    auto pair_distance = std::make_pair(first->id_, second->id_);
     distance_to_stop.insert({pair_distance, distance});
+    Unfreeze();
+    }
+
+void TransportCatalogue::Freeze() {
+    // Обратное расстояние нужно только там, где прямого нет
+    std::vector<std::pair<StopId, StopDistance>> distances;
+    distances.reserve(distance_to_stop.size() * 2);
+    for (const auto& [stops_pair, distance] : distance_to_stop) {
+        distances.push_back({stops_pair.first, {stops_pair.second, distance}});
+        if (distance_to_stop.count({stops_pair.second, stops_pair.first}) == 0) {
+            distances.push_back({stops_pair.second, {stops_pair.first, distance}});
+        }
+    }
+    std::sort(distances.begin(), distances.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(lhs.first, lhs.second.to) < std::tie(rhs.first, rhs.second.to);
+    });
+
+    distance_offsets_.assign(stops_.size() + 1, 0);
+    frozen_distances_.clear();
+    frozen_distances_.reserve(distances.size());
+    for (const auto& [from, stop_distance] : distances) {
+        ++distance_offsets_[from + 1];
+        frozen_distances_.push_back(stop_distance);
+    }
+    for (size_t stop = 0; stop < stops_.size(); ++stop) {
+        distance_offsets_[stop + 1] += distance_offsets_[stop];
+    }
+
+    // Автобусы перебираются по возрастанию названия, поэтому и у каждой остановки они по названию.
+    // Автобус, проходящий через остановку несколько раз, записывается один раз
+    const BusId NO_BUS = static_cast<BusId>(buses_.size());
+    std::vector<BusId> last_stop_bus(stops_.size(), NO_BUS);
+    stop_bus_offsets_.assign(stops_.size() + 1, 0);
+    for (const Bus* bus : sorted_buses_) {
+        for (const Stop* stop : bus->stops_) {
+            if (last_stop_bus[stop->id_] != bus->id_) {
+                last_stop_bus[stop->id_] = bus->id_;
+                ++stop_bus_offsets_[stop->id_ + 1];
+            }
+        }
     }
+    for (size_t stop = 0; stop < stops_.size(); ++stop) {
+        stop_bus_offsets_[stop + 1] += stop_bus_offsets_[stop];
+    }
+    stop_bus_ids_.resize(stop_bus_offsets_.back());
+    std::vector<size_t> positions(stop_bus_offsets_.begin(), stop_bus_offsets_.end() - 1);
+    std::fill(last_stop_bus.begin(), last_stop_bus.end(), NO_BUS);
+    for (const Bus* bus : sorted_buses_) {
+        for (const Stop* stop : bus->stops_) {
+            if (last_stop_bus[stop->id_] != bus->id_) {
+                last_stop_bus[stop->id_] = bus->id_;
+                stop_bus_ids_[positions[stop->id_]++] = bus->id_;
+            }
+        }
+    }
+
+    auto build_name_index = [](const auto& name_to_item) {
+        std::vector<std::pair<std::string_view, uint32_t>> names;
+        names.reserve(name_to_item.size());
+        for (const auto& [name, item] : name_to_item) {
+            names.emplace_back(name, item->id_);
+        }
+        return PerfectHashIndex(names);
+    };
+    stop_name_index_ = build_name_index(stopname_to_stop_);
+    bus_name_index_ = build_name_index(busname_to_bus_);
+
+    // Статистика считается уже по замороженным расстояниям
+    // Автобусы делятся на равные части по аппаратным потокам, но не меньше BUSES_PER_THREAD на поток
+    const size_t BUSES_PER_THREAD = 64;
+    bus_infos_.resize(buses_.size());
+    const size_t thread_count = std::clamp<size_t>(buses_.size() / BUSES_PER_THREAD, 1,
+                                                   std::max(1u, std::thread::hardware_concurrency()));
+    auto compute_bus_infos = [this, thread_count](size_t part) {
+        const size_t end = buses_.size() * (part + 1) / thread_count;
+        for (size_t bus = buses_.size() * part / thread_count; bus < end; ++bus) {
+            bus_infos_[bus] = ComputeBusInfo(&buses_[bus]);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t part = 1; part < thread_count; ++part) {
+        workers.emplace_back(compute_bus_infos, part);
+    }
+    compute_bus_infos(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+bool TransportCatalogue::IsFrozen() const {
+    return !distance_offsets_.empty();
+}
+
+void TransportCatalogue::Unfreeze() {
+    distance_offsets_.clear();
+    frozen_distances_.clear();
+    bus_infos_.clear();
+    stop_bus_offsets_.clear();
+    stop_bus_ids_.clear();
+    stop_name_index_ = {};
+    bus_name_index_ = {};
+}
 
 Stop* TransportCatalogue::GetStop(std::string_view stop)const {
+    if (IsFrozen()) {
+        const StopId id = stop_name_index_.Find(stop);
+        return id == PerfectHashIndex::NOT_FOUND ? nullptr : const_cast<Stop*>(&stops_[id]);
+    }
     auto it = stopname_to_stop_.find(stop);
     if(it == stopname_to_stop_.end()) {
         return nullptr;
@@ -32,6 +153,10 @@ Stop* TransportCatalogue::GetStop(std::string_view stop)const {
 }
 
 Bus* TransportCatalogue::GetBus(std::string_view bus) const {
+    if (IsFrozen()) {
+        const BusId id = bus_name_index_.Find(bus);
+        return id == PerfectHashIndex::NOT_FOUND ? nullptr : const_cast<Bus*>(&buses_[id]);
+    }
     auto it = busname_to_bus_.find(bus);
     if(it == busname_to_bus_.end()) {
         return nullptr;
@@ -39,16 +164,20 @@ Bus* TransportCatalogue::GetBus(std::string_view bus) const {
     return it->second;    
 }
 
+const Stop* TransportCatalogue::GetStopById(StopId id) const {
+    return &stops_.at(id);
+}
+
+const Bus* TransportCatalogue::GetBusById(BusId id) const {
+    return &buses_.at(id);
+}
+
 const std::deque<Bus>& TransportCatalogue::GetBuses() const {
     return buses_;
 }
 
-const std::deque<Bus>& TransportCatalogue::GetSortedAllBuses() const {
-    static std::deque<Bus> buses{buses_};
-    std::sort(buses.begin(), buses.end(), [](const Bus& lhs, const Bus& rhs) {
-        return lhs.name_ < rhs.name_;
-    });
-    return buses;
+const std::vector<const Bus*>& TransportCatalogue::GetSortedAllBuses() const {
+    return sorted_buses_;
 }
 
 const std::deque<Stop>& TransportCatalogue::GetStops() const  {
@@ -57,10 +186,17 @@ const std::deque<Stop>& TransportCatalogue::GetStops() const  {
 
 const BusInfo TransportCatalogue::GetBusInfo(std::string_view bus_name) const {
     const Bus* bus = GetBus(bus_name);
+    if (IsFrozen()) {
+        return bus_infos_[bus->id_];
+    }
+    return ComputeBusInfo(bus);
+}
+
+BusInfo TransportCatalogue::ComputeBusInfo(const Bus* bus) const {
     size_t size = GetNumberOfStops(bus);
     int unique_stops = GetUniqueStops(bus);
-    double curvature = GetDistanceToBus(bus)/GetLengthRoute(bus);
     int length_route = GetDistanceToBus(bus);
+    double curvature = length_route/GetLengthRoute(bus);
     return {size, unique_stops, length_route, curvature};
 }
 
@@ -91,12 +227,20 @@ double TransportCatalogue::GetLengthRoute(const Bus* bus) const {
 
 
 int TransportCatalogue::GetDistance(const Stop* first, const Stop* second) const {
-        auto distance_pair = std::make_pair(first, second);
+    if (IsFrozen()) {
+        const auto begin = frozen_distances_.begin() + distance_offsets_[first->id_];
+        const auto end = frozen_distances_.begin() + distance_offsets_[first->id_ + 1];
+        const auto it = std::lower_bound(begin, end, second->id_, [](const StopDistance& lhs, StopId to) {
+            return lhs.to < to;
+        });
+        return it != end && it->to == second->id_ ? it->distance : 0;
+    }
+        auto distance_pair = std::make_pair(first->id_, second->id_);
 	auto search = distance_to_stop.find(distance_pair);
 	if (search != distance_to_stop.end()) {
 	    return search->second;
 	}
-        distance_pair = std::make_pair(second, first);
+        distance_pair = std::make_pair(second->id_, first->id_);
 	search = distance_to_stop.find(distance_pair);
 	if (search != distance_to_stop.end()) {
 	    return search->second;
@@ -104,13 +248,20 @@ int TransportCatalogue::GetDistance(const Stop* first, const Stop* second) const
         return 0;
 }
 
+const std::unordered_map<std::pair<StopId, StopId>, int, Hasher>& TransportCatalogue::GetDistances() const {
+    return distance_to_stop;
+}
+
 const Buses& TransportCatalogue::GetBusesToStop(const Stop* stop) const {
-    static Buses empty_set = {};
-    auto it = stopname_to_buses_.find(stop->name_);
-    if (it == stopname_to_buses_.end()) {
-        return empty_set;
+    return stop_buses_.at(stop->id_);
+}
+
+ranges::Range<const BusId*> TransportCatalogue::GetBusIdsToStop(const Stop* stop) const {
+    if (!IsFrozen()) {
+        throw std::logic_error("Catalogue isn't frozen");
     }
-    return it->second;
+    const BusId* ids = stop_bus_ids_.data();
+    return {ids + stop_bus_offsets_.at(stop->id_), ids + stop_bus_offsets_.at(stop->id_ + 1)};
 }
 
 }//namespace tranport_catalogue
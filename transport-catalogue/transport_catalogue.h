@@ -11,31 +11,74 @@
 
 #include "geo.h"
 #include "domain.h"
+#include "name_arena.h"
+#include "perfect_hash.h"
+#include "ranges.h"
 
 namespace tc{
 
 
 class TransportCatalogue {
 public:
+    // Названия копируются в арену справочника, так что строки, на которые
+    // указывают stop.name_ и bus.name_, нужны только на время вызова
     void AddStop(const Stop& stop);
-    void AddBus(const Bus& bus);
+    void AddBus(Bus bus);
     void SetDistance(const Stop* first, const Stop* second, int distance);
+    // Переводит расстояния в компактную форму для быстрого GetDistance: у каждой остановки -
+    // отсортированный по номеру массив расстояний до соседей, в котором обратные расстояния
+    // уже подставлены там, где прямого нет. Заодно параллельно считает статистику всех
+    // автобусов для GetBusInfo, раскладывает автобусы остановок по массивам и строит
+    // совершенные хеш-таблицы названий для GetStop и GetBus. Вызывается после заполнения справочника.
+    // AddStop, AddBus и SetDistance возвращают справочник в обычный режим до следующего Freeze
+    void Freeze();
+    bool IsFrozen() const;
     Stop* GetStop(std::string_view stop) const;
     Bus* GetBus(std::string_view bus) const; 
+    // Бросают std::out_of_range для неизвестного номера
+    const Stop* GetStopById(StopId id) const;
+    const Bus* GetBusById(BusId id) const;
     const std::deque<Stop>& GetStops() const;
     const std::deque<Bus>& GetBuses() const;
-    const std::deque<Bus>& GetSortedAllBuses() const;
+    // Автобусы по возрастанию названия
+    const std::vector<const Bus*>& GetSortedAllBuses() const;
     const BusInfo GetBusInfo(std::string_view bus_name) const;
     const Buses& GetBusesToStop(const Stop* stop) const;
+    // Номера автобусов через остановку по возрастанию названия, подряд в одном массиве.
+    // Только для замороженного справочника, иначе бросает std::logic_error
+    ranges::Range<const BusId*> GetBusIdsToStop(const Stop* stop) const;
     int GetDistance(const Stop* first, const Stop* second) const;
+    // Расстояния по парам номеров остановок (from, to)
+    const std::unordered_map<std::pair<StopId, StopId>, int, Hasher>& GetDistances() const;
 private:
+    NameArena names_;  // Названия остановок и автобусов
     std::deque<Stop> stops_;
     std::deque<Bus> buses_;
     std::unordered_map<std::string_view, Stop*> stopname_to_stop_;
     std::unordered_map<std::string_view, Bus*> busname_to_bus_;
-    std::unordered_map<std::string_view, Buses> stopname_to_buses_;
-    std::unordered_map<std::pair<const Stop*, const Stop*>, int, Hasher> distance_to_stop;
+    std::vector<const Bus*> sorted_buses_;  // По названию, пополняется в AddBus
+    std::vector<Buses> stop_buses_;  // По номеру остановки
+    std::unordered_map<std::pair<StopId, StopId>, int, Hasher> distance_to_stop;
 
+    struct StopDistance {
+        StopId to;
+        int distance;
+    };
+    // После Freeze расстояния от остановки s - [distance_offsets_[s], distance_offsets_[s + 1])
+    // в frozen_distances_ по возрастанию to; пустой distance_offsets_ - справочник не заморожен
+    std::vector<size_t> distance_offsets_;
+    std::vector<StopDistance> frozen_distances_;
+    std::vector<BusInfo> bus_infos_;  // После Freeze, по номеру автобуса
+    // После Freeze автобусы через остановку s - [stop_bus_offsets_[s], stop_bus_offsets_[s + 1]) в stop_bus_ids_
+    std::vector<size_t> stop_bus_offsets_;
+    std::vector<BusId> stop_bus_ids_;
+    // После Freeze: номера остановок и автобусов по названиям
+    PerfectHashIndex stop_name_index_;
+    PerfectHashIndex bus_name_index_;
+
+    void Unfreeze();
+
+    BusInfo ComputeBusInfo(const Bus* bus) const;
     size_t GetNumberOfStops(const Bus* bus) const;
     size_t GetUniqueStops(const Bus* bus) const;
     double GetLengthRoute(const Bus* bus) const;
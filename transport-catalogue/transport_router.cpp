@@ -1,39 +1,693 @@
+#define _USE_MATH_DEFINES
 #include "transport_catalogue.h"
 #include "transport_router.h"
+#include "raptor_router.h"
+#include "serialization.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <thread>
+#include <tuple>
 
 namespace tc::router {
 
+Minutes ComputeRideTime(const RoutingSettings& settings, size_t distance) {
+  static const double KM = 1000.0;
+  static const int HOUR = 60;
+  return Minutes(static_cast<double>(distance) / (settings.bus_velocity * KM / HOUR));
+}
+
+namespace {
+
+const double EARTH_RADIUS = 6371000.0;
+
+graph::AStarRouter<Minutes>::Point ComputeUnitVector(geo::Coordinates coordinates) {
+  static const double DR = M_PI / 180.0;
+  const double lat = coordinates.lat * DR;
+  const double lng = coordinates.lng * DR;
+  return {std::cos(lat) * std::cos(lng), std::cos(lat) * std::sin(lng), std::sin(lat)};
+}
+
+double ComputeChordLength(geo::Coordinates from, geo::Coordinates to) {
+  const auto lhs = ComputeUnitVector(from);
+  const auto rhs = ComputeUnitVector(to);
+  return EARTH_RADIUS * std::hypot(lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z);
+}
+
+double ComputeRoadToChordRatio(const TransportCatalogue& catalogue) {
+  double ratio = 1.0;
+  for (const auto& bus : catalogue.GetBuses()) {
+    for (size_t i = 1; i < bus.stops_.size(); ++i) {
+      const double chord = ComputeChordLength(bus.stops_[i - 1]->coordinates_, bus.stops_[i]->coordinates_);
+      if (chord > 0) {
+        ratio = std::min(ratio, catalogue.GetDistance(bus.stops_[i - 1], bus.stops_[i]) / chord);
+      }
+    }
+  }
+  return std::max(ratio, 0.0);
+}
+
+}  // namespace
+
 TransportRouter::TransportRouter(RoutingSettings settings, const TransportCatalogue& catalogue)
   : settings_(settings) {
-  const auto& stops = catalogue.GetStops();
-  const size_t vertex_count = stops.size() * 2;  // По две вершины на остановку
+  if (settings_.router_type == RouterType::RAPTOR) {
+    raptor_router_ = std::make_unique<RaptorRouter>(settings_, catalogue);
+    return;
+  }
+
+  const size_t vertex_count = CountVertices(catalogue);
   graph_ = graph::DirectedWeightedGraph<Minutes>(vertex_count);
-  vertexes_.resize(vertex_count);
+  topology_->vertexes.resize(vertex_count);
 
   AddStopsToGraph(catalogue);
   AddBusesToGraph(catalogue);
+  topology_->road_to_chord_ratio = ComputeRoadToChordRatio(catalogue);
+  if (settings_.prune_dominated_edges) {
+    topology_->pruned_edge_count = PruneDominatedEdges();
+  }
+  FreezeGraph();
+
+  BuildRouter();
+}
+
+namespace {
+
+const uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+
+struct EdgeRecord {
+  uint32_t bus;  // NO_INDEX - ребро ожидания
+  uint32_t padding = 0;  // Явно обнулённое выравнивание, чтобы снимок не зависел от мусора в памяти
+  uint64_t span_count;
+  uint64_t distance;
+};
+
+void WriteSettings(serialization::SnapshotWriter& writer, const RoutingSettings& settings) {
+  writer.WriteValue<int64_t>(settings.bus_wait_time.count());
+  writer.WriteValue(settings.bus_velocity);
+  writer.WriteValue(settings.router_type);
+  writer.WriteValue(settings.graph_model);
+  writer.WriteValue<uint64_t>(settings.router_threads);
+  writer.WriteValue(settings.prune_dominated_edges);
+}
+
+// Значение перечисления от первого до last
+template <typename Enum>
+Enum ReadEnum(serialization::SnapshotReader& reader, Enum last) {
+  using Underlying = std::underlying_type_t<Enum>;
+  const auto value = reader.ReadValue<Underlying>();
+  serialization::CheckIntegrity(value >= 0 && value <= static_cast<Underlying>(last));
+  return static_cast<Enum>(value);
+}
+
+RoutingSettings ReadSettings(serialization::SnapshotReader& reader) {
+  RoutingSettings settings;
+  settings.bus_wait_time = std::chrono::minutes(reader.ReadValue<int64_t>());
+  settings.bus_velocity = reader.ReadValue<double>();
+  settings.router_type = ReadEnum(reader, RouterType::ASTAR);
+  settings.graph_model = ReadEnum(reader, GraphModel::SINGLE_VERTEX);
+  settings.router_threads = reader.ReadValue<uint64_t>();
+  settings.prune_dominated_edges = reader.ReadBool();
+  return settings;
+}
+
+// Граф в форме CSR: смещения не убывают, рёбра вершины v идут в [offsets[v], offsets[v + 1]),
+// выходят из v и ведут в существующую вершину, веса неотрицательны
+void CheckGraph(const std::vector<graph::Edge<Minutes>>& edges, const std::vector<graph::EdgeId>& offsets) {
+  serialization::CheckIntegrity(!offsets.empty() && offsets.front() == 0 && offsets.back() == edges.size());
+  const size_t vertex_count = offsets.size() - 1;
+  for (graph::VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+    serialization::CheckIntegrity(offsets[vertex] <= offsets[vertex + 1]);
+    for (graph::EdgeId edge_id = offsets[vertex]; edge_id < offsets[vertex + 1]; ++edge_id) {
+      const auto& edge = edges[edge_id];
+      serialization::CheckIntegrity(edge.from == vertex && edge.to < vertex_count && edge.weight >= Minutes(0));
+    }
+  }
+}
+
+}  // namespace
+
+TransportRouter::TransportRouter(const TransportCatalogue& catalogue, serialization::SnapshotReader& reader)
+  : settings_(ReadSettings(reader)) {
+  if (settings_.router_type == RouterType::RAPTOR) {
+    raptor_router_ = std::make_unique<RaptorRouter>(settings_, catalogue);
+    return;
+  }
+
+  auto graph_edges = reader.ReadVector<graph::Edge<Minutes>>();
+  auto graph_offsets = reader.ReadVector<graph::EdgeId>();
+  CheckGraph(graph_edges, graph_offsets);
+  graph_ = graph::DirectedWeightedGraph<Minutes>(std::move(graph_edges), std::move(graph_offsets));
+  const size_t vertex_count = graph_.GetVertexCount();
+  next_vertex_id_ = vertex_count;
+
+  const auto edge_records = reader.ReadArray<EdgeRecord>();
+  serialization::CheckIntegrity(edge_records.size() == graph_.GetEdgeCount());
+  for (const auto& record : edge_records) {
+    if (record.bus == NO_INDEX) {
+      topology_->edges.emplace_back(std::nullopt);
+    } else {
+      serialization::CheckIntegrity(record.bus < catalogue.GetBuses().size());
+      topology_->edges.emplace_back(BusEdge{catalogue.GetBusById(record.bus), record.span_count, record.distance});
+    }
+  }
+  const auto vertex_stops = reader.ReadArray<uint32_t>();
+  serialization::CheckIntegrity(vertex_stops.size() == vertex_count);
+  for (const uint32_t stop : vertex_stops) {
+    serialization::CheckIntegrity(stop < catalogue.GetStops().size());
+    topology_->vertexes.push_back(catalogue.GetStopById(stop));
+  }
+  topology_->stops_vertex_ids = reader.ReadVector<StopVertexIds>();
+  serialization::CheckIntegrity(topology_->stops_vertex_ids.size() == catalogue.GetStops().size());
+  for (const auto& vertex_ids : topology_->stops_vertex_ids) {
+    serialization::CheckIntegrity(vertex_ids.in < vertex_count && vertex_ids.out < vertex_count);
+  }
+  topology_->road_to_chord_ratio = reader.ReadValue<double>();
+  topology_->pruned_edge_count = reader.ReadValue<uint64_t>();
+
+  LoadRoutesTable(reader);
+}
+
+TransportRouter::~TransportRouter() = default;
+
+TransportRouter::TransportRouter(const TransportRouter& base, const RoutingSettings& settings)
+  : TransportRouter(base, settings, nullptr) {
+}
+
+TransportRouter::TransportRouter(const TransportRouter& base, const RoutingSettings& settings,
+                                 serialization::SnapshotReader& reader)
+  : TransportRouter(base, settings, &reader) {
+}
+
+TransportRouter::TransportRouter(const TransportRouter& base, const RoutingSettings& settings,
+                                 serialization::SnapshotReader* reader)
+  : settings_(base.settings_)
+  , graph_(base.graph_)
+  , topology_(base.topology_)
+  , next_vertex_id_(base.next_vertex_id_) {
+  base.CheckSameTopology(settings);
+  settings_ = settings;
+  if (base.raptor_router_) {
+    raptor_router_ = std::make_unique<RaptorRouter>(*base.raptor_router_);
+    raptor_router_->ApplySettings(settings_);
+    return;
+  }
+  UpdateEdgeWeights();
+  if (reader) {
+    LoadRoutesTable(*reader);
+  } else {
+    BuildRouter();
+  }
+}
+
+void TransportRouter::CheckSameTopology(const RoutingSettings& settings) const {
+  if (settings.graph_model != settings_.graph_model || settings.prune_dominated_edges != settings_.prune_dominated_edges
+      || (settings.router_type == RouterType::RAPTOR) != (settings_.router_type == RouterType::RAPTOR)) {
+    throw std::logic_error("Graph model can't be changed without rebuilding the router");
+  }
+}
+
+void TransportRouter::ApplySettings(const RoutingSettings& settings) {
+  CheckSameTopology(settings);
+  settings_ = settings;
+  if (raptor_router_) {
+    raptor_router_->ApplySettings(settings_);
+    return;
+  }
 
-  router_ = std::make_unique<graph::Router<Minutes>>(graph_);
+  UpdateEdgeWeights();
+  BuildRouter();
+  snapshot_file_.reset();
+}
+
+void TransportRouter::UpdateEdgeWeights() {
+  for (graph::EdgeId edge_id = 0; edge_id < topology_->edges.size(); ++edge_id) {
+    graph_.SetEdgeWeight(edge_id, ComputeEdgeWeight(topology_->edges[edge_id]));
+  }
+}
+
+void TransportRouter::Save(serialization::SnapshotWriter& writer) const {
+  WriteSettings(writer, settings_);
+  if (raptor_router_) {
+    return;
+  }
+
+  // Граф заморожен: рёбра уже упорядочены по вершине from
+  const size_t vertex_count = graph_.GetVertexCount();
+  std::vector<graph::Edge<Minutes>> graph_edges;
+  graph_edges.reserve(graph_.GetEdgeCount());
+  for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+    graph_edges.push_back(graph_.GetEdge(edge_id));
+  }
+  std::vector<graph::EdgeId> graph_offsets(vertex_count + 1, 0);
+  for (graph::VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+    const auto incident_edges = graph_.GetIncidentEdges(vertex);
+    graph_offsets[vertex + 1] = graph_offsets[vertex] + std::distance(incident_edges.begin(), incident_edges.end());
+  }
+  writer.WriteArray(graph_edges);
+  writer.WriteArray(graph_offsets);
+
+  std::vector<EdgeRecord> edge_records;
+  edge_records.reserve(topology_->edges.size());
+  for (const auto& edge_info : topology_->edges) {
+    if (edge_info) {
+      edge_records.push_back({edge_info->bus->id_, 0, edge_info->span_count, edge_info->distance});
+    } else {
+      edge_records.push_back({NO_INDEX, 0, 0, 0});
+    }
+  }
+  writer.WriteArray(edge_records);
+
+  std::vector<uint32_t> vertex_stops;
+  vertex_stops.reserve(topology_->vertexes.size());
+  for (const Stop* stop : topology_->vertexes) {
+    vertex_stops.push_back(stop->id_);
+  }
+  writer.WriteArray(vertex_stops);
+  writer.WriteArray(topology_->stops_vertex_ids);
+  writer.WriteValue(topology_->road_to_chord_ratio);
+  writer.WriteValue<uint64_t>(topology_->pruned_edge_count);
+
+  SaveRoutesTable(writer);
+}
+
+void TransportRouter::SaveProfile(serialization::SnapshotWriter& writer) const {
+  if (!raptor_router_) {
+    SaveRoutesTable(writer);
+  }
+}
+
+void TransportRouter::SaveRoutesTable(serialization::SnapshotWriter& writer) const {
+  const auto* all_pairs_router = std::get_if<std::unique_ptr<graph::Router<Minutes>>>(&router_);
+  writer.WriteValue<bool>(all_pairs_router);
+  if (all_pairs_router) {
+    const size_t vertex_count = graph_.GetVertexCount();
+    const size_t table_size = vertex_count * vertex_count;
+    const auto routes_table = (*all_pairs_router)->GetRoutesTable();
+    writer.WriteArray(routes_table.weights, table_size);
+    writer.WriteArray(routes_table.prev_edges, table_size);
+  }
+}
+
+void TransportRouter::LoadRoutesTable(serialization::SnapshotReader& reader) {
+  const bool has_routes_table = reader.ReadBool();
+  serialization::CheckIntegrity(has_routes_table == (settings_.router_type == RouterType::ALL_PAIRS));
+  if (!has_routes_table) {
+    BuildRouter();
+    return;
+  }
+
+  using AllPairsRouter = graph::Router<Minutes>;
+  const auto weights = reader.ReadArray<double>();
+  const auto prev_edges = reader.ReadArray<AllPairsRouter::PrevEdge>();
+  // Таблица vertex_count x vertex_count; произведение может переполниться, поэтому проверяется делением
+  const size_t vertex_count = graph_.GetVertexCount();
+  const size_t table_size = weights.size();
+  serialization::CheckIntegrity(prev_edges.size() == table_size && (vertex_count == 0
+    ? table_size == 0
+    : table_size % vertex_count == 0 && table_size / vertex_count == vertex_count));
+  router_ = std::make_unique<AllPairsRouter>(graph_, AllPairsRouter::RoutesTable{weights.begin(), prev_edges.begin()},
+                                             table_size);
+  snapshot_file_ = reader.GetFile();
+  BuildSearchRouter();
+}
+
+size_t TransportRouter::GetRouterThreadCount() const {
+  const size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+  if (settings_.router_threads == 0) {
+    return hardware_threads;
+  }
+  return std::min(settings_.router_threads, hardware_threads);
+}
+
+const RoutingSettings& TransportRouter::GetSettings() const {
+  return settings_;
+}
+
+const graph::DirectedWeightedGraph<Minutes>& TransportRouter::GetGraph() const {
+  return graph_;
+}
+
+size_t TransportRouter::GetPrunedEdgeCount() const {
+  return topology_->pruned_edge_count;
+}
+
+bool TransportRouter::IsBetterEdge(graph::EdgeId lhs, graph::EdgeId rhs) const {
+  const Minutes lhs_weight = graph_.GetEdge(lhs).weight;
+  const Minutes rhs_weight = graph_.GetEdge(rhs).weight;
+  if (lhs_weight != rhs_weight) {
+    return lhs_weight < rhs_weight;
+  }
+  const auto& lhs_info = topology_->edges[lhs];
+  const auto& rhs_info = topology_->edges[rhs];
+  if (!lhs_info || !rhs_info) {
+    return !lhs_info && rhs_info;
+  }
+  return std::tie(lhs_info->bus->name_, lhs_info->span_count) < std::tie(rhs_info->bus->name_, rhs_info->span_count);
+}
+
+size_t TransportRouter::PruneDominatedEdges() {
+  const size_t vertex_count = graph_.GetVertexCount();
+  const size_t edge_count = graph_.GetEdgeCount();
+  std::vector<bool> is_kept(edge_count, false);
+  // Лучшее ребро из текущей вершины в каждую вершину to
+  std::vector<std::optional<graph::EdgeId>> best_edges(vertex_count);
+  std::vector<graph::VertexId> touched;
+
+  for (graph::VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+    for (const graph::EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+      auto& best_edge = best_edges[graph_.GetEdge(edge_id).to];
+      if (!best_edge) {
+        touched.push_back(graph_.GetEdge(edge_id).to);
+        best_edge = edge_id;
+      } else if (IsBetterEdge(edge_id, *best_edge)) {
+        best_edge = edge_id;
+      }
+    }
+    for (const graph::VertexId to : touched) {
+      is_kept[*best_edges[to]] = true;
+      best_edges[to].reset();
+    }
+    touched.clear();
+  }
+
+  // Оставшиеся рёбра добавляются в прежнем порядке
+  graph::DirectedWeightedGraph<Minutes> graph(vertex_count);
+  std::vector<EdgeInfo> edges;
+  for (graph::EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+    if (is_kept[edge_id]) {
+      graph.AddEdge(graph_.GetEdge(edge_id));
+      edges.push_back(topology_->edges[edge_id]);
+    }
+  }
+  graph_ = std::move(graph);
+  topology_->edges = std::move(edges);
+  return edge_count - topology_->edges.size();
+}
+
+void TransportRouter::FreezeGraph() {
+  const auto new_edge_ids = graph_.Freeze();
+  std::vector<EdgeInfo> edges(topology_->edges.size());
+  for (graph::EdgeId edge_id = 0; edge_id < topology_->edges.size(); ++edge_id) {
+    edges[new_edge_ids[edge_id]] = topology_->edges[edge_id];
+  }
+  topology_->edges = std::move(edges);
+}
+
+void TransportRouter::BuildRouter() {
+  switch (settings_.router_type) {
+    case RouterType::ALL_PAIRS:
+      router_ = std::make_unique<graph::Router<Minutes>>(graph_, GetRouterThreadCount());
+      break;
+    case RouterType::DIJKSTRA:
+      router_ = std::make_unique<graph::DijkstraRouter<Minutes>>(graph_);
+      break;
+    case RouterType::CONTRACTION_HIERARCHY:
+      router_ = std::make_unique<graph::ContractionHierarchy<Minutes>>(graph_);
+      break;
+    case RouterType::ASTAR:
+      router_ = std::make_unique<graph::AStarRouter<Minutes>>(graph_, ComputeVertexPoints());
+      break;
+    case RouterType::RAPTOR:
+      return;
+  }
+  BuildSearchRouter();
+}
+
+void TransportRouter::BuildSearchRouter() {
+  if (std::holds_alternative<std::unique_ptr<graph::DijkstraRouter<Minutes>>>(router_)) {
+    search_router_.reset();
+  } else {
+    search_router_ = std::make_unique<graph::DijkstraRouter<Minutes>>(graph_);
+  }
+}
+
+const graph::DijkstraRouter<Minutes>& TransportRouter::GetSearchRouter() const {
+  if (const auto* dijkstra_router = std::get_if<std::unique_ptr<graph::DijkstraRouter<Minutes>>>(&router_)) {
+    return **dijkstra_router;
+  }
+  return *search_router_;
+}
+
+// Точка вершины - точка её остановки на сфере, масштабированная так, что расстояние
+// между точками равно времени поездки по дорогам длиной в хорду, умноженную на topology_->road_to_chord_ratio.
+// Ожидание и поездки по настоящим дорогам не короче, поэтому оценка допустима
+std::vector<graph::AStarRouter<Minutes>::Point> TransportRouter::ComputeVertexPoints() const {
+  const double scale = EARTH_RADIUS * topology_->road_to_chord_ratio * ComputeRideTime(settings_, 1).count();
+  std::vector<graph::AStarRouter<Minutes>::Point> points;
+  points.reserve(topology_->vertexes.size());
+  for (const Stop* stop : topology_->vertexes) {
+    const auto unit_vector = ComputeUnitVector(stop->coordinates_);
+    points.push_back({unit_vector.x * scale, unit_vector.y * scale, unit_vector.z * scale});
+  }
+  return points;
 }
 
 std::optional<RouteInfo> TransportRouter::FindRoute(const Stop* from, const Stop* to) const {
-  const graph::VertexId vertex_from = stops_vertex_ids_.at(from).out;
-  const graph::VertexId vertex_to = stops_vertex_ids_.at(to).out;
-  const auto route = router_->BuildRoute(vertex_from, vertex_to);
+  if (raptor_router_) {
+    return raptor_router_->FindRoute(from, to);
+  }
+  const RouteInfo* route = FindRoute(from, to, GetThreadQueryContext());
+  return route ? std::optional(*route) : std::nullopt;
+}
+
+namespace {
 
+template <typename GraphRouter>
+std::optional<Minutes> BuildRoute(const GraphRouter& router, graph::VertexId from, graph::VertexId to,
+                                  graph::QueryContext<Minutes>& context) {
+  const auto route = router.BuildRoute(from, to);
   if (!route) {
     return std::nullopt;
   }
+  context.GetRouteEdges().assign(route->edges.begin(), route->edges.end());
+  return route->weight;
+}
+
+std::optional<Minutes> BuildRoute(const graph::Router<Minutes>& router, graph::VertexId from, graph::VertexId to,
+                                  graph::QueryContext<Minutes>& context) {
+  return router.BuildRoute(from, to, context);
+}
+
+std::optional<Minutes> BuildRoute(const graph::DijkstraRouter<Minutes>& router, graph::VertexId from,
+                                  graph::VertexId to, graph::QueryContext<Minutes>& context) {
+  return router.BuildRoute(from, to, context);
+}
+
+// Маршруты из from во все вершины to по очереди: on_route(i, вес) получает маршрут до to[i],
+// его рёбра - в context.GetRouteEdges()
+template <typename GraphRouter, typename RouteCallback>
+void BuildRoutes(const GraphRouter& router, graph::VertexId from, const std::vector<graph::VertexId>& to,
+                 graph::QueryContext<Minutes>& context, RouteCallback on_route) {
+  for (size_t i = 0; i < to.size(); ++i) {
+    on_route(i, BuildRoute(router, from, to[i], context));
+  }
+}
+
+template <typename RouteCallback>
+void BuildRoutes(const graph::DijkstraRouter<Minutes>& router, graph::VertexId from,
+                 const std::vector<graph::VertexId>& to, graph::QueryContext<Minutes>& context,
+                 RouteCallback on_route) {
+  router.Search(from, to, context);
+  for (size_t i = 0; i < to.size(); ++i) {
+    on_route(i, router.GetFoundRoute(to[i], context));
+  }
+}
+
+}  // namespace
+
+TransportRouter::QueryContext& TransportRouter::GetThreadQueryContext() {
+  thread_local QueryContext context;
+  return context;
+}
+
+const RouteInfo* TransportRouter::FindRoute(const Stop* from, const Stop* to, QueryContext& context) const {
+  if (raptor_router_) {
+    auto route = raptor_router_->FindRoute(from, to);
+    if (!route) {
+      return nullptr;
+    }
+    context.route = std::move(*route);
+    return &context.route;
+  }
+
+  const graph::VertexId vertex_from = topology_->stops_vertex_ids.at(from->id_).out;
+  const graph::VertexId vertex_to = topology_->stops_vertex_ids.at(to->id_).out;
+  const auto total_time = std::visit([vertex_from, vertex_to, &context](const auto& router) {
+    return BuildRoute(*router, vertex_from, vertex_to, context.search);
+  }, router_);
+
+  if (!total_time) {
+    return nullptr;
+  }
+  FillRouteInfo(*total_time, context.search.GetRouteEdges(), context.route);
+  return &context.route;
+}
+
+const std::vector<const RouteInfo*>& TransportRouter::FindRoutes(const Stop* from,
+                                                                 const std::vector<const Stop*>& to,
+                                                                 QueryContext& context) const {
+  // Маршруты не удаляются из пула: их буферы items нужны следующим запросам
+  if (context.routes.size() < to.size()) {
+    context.routes.resize(to.size());
+  }
+  context.found_routes.clear();
+
+  if (raptor_router_) {
+    auto routes = raptor_router_->FindRoutes(from, to);
+    for (size_t i = 0; i < routes.size(); ++i) {
+      if (routes[i]) {
+        context.routes[i] = std::move(*routes[i]);
+        context.found_routes.push_back(&context.routes[i]);
+      } else {
+        context.found_routes.push_back(nullptr);
+      }
+    }
+    return context.found_routes;
+  }
+
+  const graph::VertexId vertex_from = topology_->stops_vertex_ids.at(from->id_).out;
+  context.vertexes.clear();
+  for (const Stop* stop : to) {
+    context.vertexes.push_back(topology_->stops_vertex_ids.at(stop->id_).out);
+  }
+  std::visit([this, vertex_from, &context](const auto& router) {
+    BuildRoutes(*router, vertex_from, context.vertexes, context.search,
+                [this, &context](size_t i, std::optional<Minutes> total_time) {
+      if (!total_time) {
+        context.found_routes.push_back(nullptr);
+        return;
+      }
+      FillRouteInfo(*total_time, context.search.GetRouteEdges(), context.routes[i]);
+      context.found_routes.push_back(&context.routes[i]);
+    });
+  }, router_);
+  return context.found_routes;
+}
+
+std::vector<std::optional<Minutes>> TransportRouter::ComputeTravelTimes(const std::vector<const Stop*>& from,
+                                                                        const std::vector<const Stop*>& to) const {
+  std::vector<graph::VertexId> vertexes_to;
+  if (!raptor_router_) {
+    vertexes_to.reserve(to.size());
+    for (const Stop* stop : to) {
+      vertexes_to.push_back(topology_->stops_vertex_ids.at(stop->id_).out);
+    }
+  }
+  // Таблицу всех пар достаточно прочитать, для остальных движков строка - это один поиск Дейкстры по графу
+  const auto* all_pairs_router = std::get_if<std::unique_ptr<graph::Router<Minutes>>>(&router_);
+  std::vector<std::optional<Minutes>> travel_times(from.size() * to.size());
+
+  auto compute_row = [&](size_t row, graph::QueryContext<Minutes>& context) {
+    const auto row_times = travel_times.begin() + row * to.size();
+    if (raptor_router_) {
+      const auto times = raptor_router_->ComputeTravelTimes(from[row], to);
+      std::copy(times.begin(), times.end(), row_times);
+      return;
+    }
+    const graph::VertexId vertex_from = topology_->stops_vertex_ids.at(from[row]->id_).out;
+    if (all_pairs_router) {
+      for (size_t column = 0; column < vertexes_to.size(); ++column) {
+        row_times[column] = (*all_pairs_router)->GetRouteWeight(vertex_from, vertexes_to[column]);
+      }
+      return;
+    }
+    GetSearchRouter().Search(vertex_from, vertexes_to, context);
+    for (size_t column = 0; column < vertexes_to.size(); ++column) {
+      const graph::VertexId vertex_to = vertexes_to[column];
+      if (context.IsReached(vertex_to)) {
+        row_times[column] = context.GetWeight(vertex_to);
+      }
+    }
+  };
+
+  std::atomic<size_t> next_row = 0;
+  auto compute_rows = [&]() {
+    auto context = AcquireSearchContext();
+    for (size_t row = next_row++; row < from.size(); row = next_row++) {
+      compute_row(row, *context);
+    }
+    ReleaseSearchContext(std::move(context));
+  };
+
+  const size_t thread_count = std::min(from.size(), GetRouterThreadCount());
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < thread_count; ++i) {
+    workers.emplace_back(compute_rows);
+  }
+  compute_rows();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return travel_times;
+}
+
+std::unique_ptr<graph::QueryContext<Minutes>> TransportRouter::AcquireSearchContext() const {
+  std::lock_guard lock(search_contexts_mutex_);
+  if (search_contexts_.empty()) {
+    return std::make_unique<graph::QueryContext<Minutes>>();
+  }
+  auto context = std::move(search_contexts_.back());
+  search_contexts_.pop_back();
+  return context;
+}
+
+void TransportRouter::ReleaseSearchContext(std::unique_ptr<graph::QueryContext<Minutes>> context) const {
+  std::lock_guard lock(search_contexts_mutex_);
+  search_contexts_.push_back(std::move(context));
+}
+
+std::vector<ReachableStop> TransportRouter::FindReachableStops(const Stop* from, Minutes max_time) const {
+  std::vector<ReachableStop> reachable_stops;
+  if (raptor_router_) {
+    reachable_stops = raptor_router_->FindReachableStops(from, max_time);
+  } else {
+    // Поиск ограничен по времени, поэтому для любого движка он идёт по графу, а не через router_
+    for (const auto& [vertex, time] : GetSearchRouter().ComputeWeightsWithin(topology_->stops_vertex_ids.at(from->id_).out, max_time)) {
+      // Прибытие на остановку - только её вершина out
+      const Stop* stop = topology_->vertexes[vertex];
+      if (topology_->stops_vertex_ids.at(stop->id_).out == vertex) {
+        reachable_stops.push_back({stop, time});
+      }
+    }
+  }
+
+  std::sort(reachable_stops.begin(), reachable_stops.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+    return std::tie(lhs.time, lhs.stop->name_) < std::tie(rhs.time, rhs.stop->name_);
+  });
+  return reachable_stops;
+}
 
-  RouteInfo route_info;
-  route_info.total_time = route->weight;
-  route_info.items.reserve(route->edges.size());
+void TransportRouter::FillRouteInfo(Minutes total_time, const std::vector<graph::EdgeId>& edges,
+                                    RouteInfo& route_info) const {
+  route_info.total_time = total_time;
+  route_info.items.clear();
+  route_info.items.reserve(edges.size() * (settings_.graph_model == GraphModel::SINGLE_VERTEX ? 2 : 1));
 
-  for (const auto edge_id : route->edges) {
+  for (const auto edge_id : edges) {
     const auto& edge = graph_.GetEdge(edge_id);
-    const auto& bus_edge_info = edges_[edge_id];
+    const auto& bus_edge_info = topology_->edges[edge_id];
 
-    if (bus_edge_info.has_value()) {
+    // Рёбра одной поездки идут подряд, без ожидания между ними
+    auto* last_bus_item = route_info.items.empty()
+      ? nullptr
+      : std::get_if<RouteInfo::BusItem>(&route_info.items.back());
+    if (bus_edge_info.has_value() && settings_.graph_model == GraphModel::SINGLE_VERTEX) {
+      // Ребро - ожидание на остановке посадки и сама поездка
+      const Minutes wait_time(settings_.bus_wait_time.count());
+      route_info.items.emplace_back(RouteInfo::WaitItem{topology_->vertexes[edge.from], wait_time});
+      route_info.items.emplace_back(RouteInfo::BusItem{
+        bus_edge_info->bus,
+        ComputeRideTime(settings_, bus_edge_info->distance),
+        bus_edge_info->span_count,
+      });
+    } else if (bus_edge_info.has_value() && last_bus_item && last_bus_item->bus == bus_edge_info->bus) {
+      last_bus_item->time += edge.weight;
+      last_bus_item->span_count += bus_edge_info->span_count;
+    } else if (bus_edge_info.has_value()) {
       route_info.items.emplace_back(RouteInfo::BusItem{
         bus_edge_info->bus,
         edge.weight,
@@ -42,73 +696,173 @@ std::optional<RouteInfo> TransportRouter::FindRoute(const Stop* from, const Stop
     } else {
       const graph::VertexId vertex_id = edge.from;
       route_info.items.emplace_back(RouteInfo::WaitItem{
-        vertexes_[vertex_id],
+        topology_->vertexes[vertex_id],
         edge.weight,
       });
     }
   }
-  return route_info;
+}
+
+Minutes TransportRouter::ComputeEdgeWeight(const EdgeInfo& edge_info) const {
+  const Minutes wait_time(settings_.bus_wait_time.count());
+  if (!edge_info) {
+    return wait_time;
+  }
+  // Посадка в модели LINEAR - ребро нулевой длины
+  const Minutes ride_time = edge_info->distance > 0 ? ComputeRideTime(settings_, edge_info->distance) : Minutes(0);
+  // В модели SINGLE_VERTEX нет рёбер ожидания, и ожидание добавляется к каждой поездке
+  return settings_.graph_model == GraphModel::SINGLE_VERTEX ? wait_time + ride_time : ride_time;
+}
+
+void TransportRouter::AddEdge(graph::VertexId from, graph::VertexId to, EdgeInfo edge_info) {
+  graph_.AddEdge({from, to, ComputeEdgeWeight(edge_info)});
+  topology_->edges.push_back(edge_info);
 }
 
 void TransportRouter::AddStopsToGraph(const TransportCatalogue& catalogue) {
-  graph::VertexId vertex_id = 0;
   const auto& stops = catalogue.GetStops();
+  topology_->stops_vertex_ids.resize(stops.size());
 
   for (const auto &stop : stops) {
-    auto& vertex_ids = stops_vertex_ids_[&stop];
-
-    vertex_ids.in = vertex_id++;
-    vertex_ids.out = vertex_id++;
-    vertexes_[vertex_ids.in] = &stop;
-    vertexes_[vertex_ids.out] = &stop;
-
-    edges_.emplace_back(std::nullopt);
-    graph_.AddEdge({
-      vertex_ids.out,
-      vertex_ids.in,
-      Minutes(settings_.bus_wait_time.count())
-    });
+    auto& vertex_ids = topology_->stops_vertex_ids[stop.id_];
+    if (settings_.graph_model == GraphModel::SINGLE_VERTEX) {
+      vertex_ids.in = vertex_ids.out = next_vertex_id_++;
+      topology_->vertexes[vertex_ids.in] = &stop;
+      continue;
+    }
+
+    vertex_ids.in = next_vertex_id_++;
+    vertex_ids.out = next_vertex_id_++;
+    topology_->vertexes[vertex_ids.in] = &stop;
+    topology_->vertexes[vertex_ids.out] = &stop;
+
+    AddEdge(vertex_ids.out, vertex_ids.in, std::nullopt);
+  }
+}
+
+size_t TransportRouter::CountVertices(const TransportCatalogue& catalogue) const {
+  if (settings_.graph_model == GraphModel::SINGLE_VERTEX) {
+    return catalogue.GetStops().size();
   }
+  size_t vertex_count = catalogue.GetStops().size() * 2;  // По две вершины на остановку
+  if (settings_.graph_model == GraphModel::LINEAR) {
+    // И по вершине на каждую остановку маршрута, кроме последней
+    for (const auto& bus : catalogue.GetBuses()) {
+      if (bus.stops_.size() > 1) {
+        vertex_count += bus.stops_.size() - 1;
+      }
+    }
+  }
+  return vertex_count;
 }
 
 void TransportRouter::AddBusesToGraph(const TransportCatalogue& catalogue) {
-  const auto& buses = catalogue.GetBuses();
-  static const double KM = 1000.0;
-  static const int HOUR = 60;
+  for (const auto& bus : catalogue.GetBuses()) {
+    if (bus.stops_.size() <= 1) {
+      continue;
+    }
+    if (settings_.graph_model == GraphModel::LINEAR) {
+      AddLinearBusToGraph(catalogue, bus);
+    } else {
+      AddCompleteBusToGraph(catalogue, bus);
+    }
+  }
+}
 
-  for (const auto& bus : buses) {
-    const auto& bus_stops = bus.stops_;
-    const size_t stop_count = bus_stops.size();
+void TransportRouter::AddCompleteBusToGraph(const TransportCatalogue& catalogue, const Bus& bus) {
+  const auto& bus_stops = bus.stops_;
+  const size_t stop_count = bus_stops.size();
 
-    if (stop_count <= 1) {
-      continue;
+  auto compute_distance_from = [&catalogue, &bus_stops](size_t stop_idx) {
+    return catalogue.GetDistance(bus_stops[stop_idx], bus_stops[stop_idx + 1]);
+  };
+
+  for (size_t begin_i = 0; begin_i + 1 < stop_count; ++begin_i) {
+    const graph::VertexId start = topology_->stops_vertex_ids.at(bus_stops[begin_i]->id_).in;
+    size_t total_distance = 0;
+
+    for (size_t end_i = begin_i + 1; end_i < stop_count; ++end_i) {
+      total_distance += compute_distance_from(end_i - 1);
+      AddEdge(start, topology_->stops_vertex_ids.at(bus_stops[end_i]->id_).out, BusEdge{
+        &bus,
+        end_i - begin_i,
+        total_distance,
+      });
     }
+  }
+}
 
-    auto compute_distance_from = [&catalogue, &bus_stops](size_t stop_idx) {
-      return catalogue.GetDistance(bus_stops[stop_idx], bus_stops[stop_idx + 1]);
-    };
-
-    for (size_t begin_i = 0; begin_i + 1 < stop_count; ++begin_i) {
-      const graph::VertexId start = stops_vertex_ids_.at(bus_stops[begin_i]).in;
-      size_t total_distance = 0;
-
-      for (size_t end_i = begin_i + 1; end_i < stop_count; ++end_i) {
-        total_distance += compute_distance_from(end_i - 1);
-        edges_.emplace_back(BusEdge{
-          &bus,
-          end_i - begin_i,
-        });
-
-        graph_.AddEdge({
-          start,
-          stops_vertex_ids_.at(bus_stops[end_i]).out,
-          Minutes(
-            static_cast<double>(total_distance)
-              / (settings_.bus_velocity * KM / HOUR)
-          )
-        });
-      }
+// Вершина ride_i - пассажир в автобусе, отправляющемся с i-й остановки маршрута.
+// Посадка: in(s_i) -> ride_i, перегон: ride_i -> ride_{i+1}, перегон с высадкой: ride_i -> out(s_{i+1}).
+// Высадиться на той же остановке, где была посадка, нельзя
+void TransportRouter::AddLinearBusToGraph(const TransportCatalogue& catalogue, const Bus& bus) {
+  const auto& bus_stops = bus.stops_;
+  const size_t stop_count = bus_stops.size();
+  const graph::VertexId first_ride_vertex = next_vertex_id_;
+  next_vertex_id_ += stop_count - 1;
+
+  for (size_t stop_i = 0; stop_i + 1 < stop_count; ++stop_i) {
+    const graph::VertexId ride_vertex = first_ride_vertex + stop_i;
+    topology_->vertexes[ride_vertex] = bus_stops[stop_i];
+
+    AddEdge(topology_->stops_vertex_ids.at(bus_stops[stop_i]->id_).in, ride_vertex, BusEdge{&bus, 0, 0});
+
+    const auto distance = static_cast<size_t>(catalogue.GetDistance(bus_stops[stop_i], bus_stops[stop_i + 1]));
+    if (stop_i + 2 < stop_count) {
+      AddEdge(ride_vertex, ride_vertex + 1, BusEdge{&bus, 1, distance});
     }
+    AddEdge(ride_vertex, topology_->stops_vertex_ids.at(bus_stops[stop_i + 1]->id_).out, BusEdge{&bus, 1, distance});
+  }
+}
+
+RoutingProfiles::RoutingProfiles(const TransportRouter& router)
+  : router_(router) {
+}
+
+RoutingProfiles::RoutingProfiles(const TransportRouter& router, serialization::SnapshotReader& reader)
+  : router_(router) {
+  const size_t profile_count = reader.ReadValue<uint64_t>();
+  for (size_t i = 0; i < profile_count; ++i) {
+    std::string name(reader.ReadString());
+    const RoutingSettings settings = ReadSettings(reader);
+    serialization::CheckIntegrity(!name.empty() && profiles_.count(name) == 0);
+    profiles_.emplace(std::move(name), std::make_unique<TransportRouter>(router_, settings, reader));
   }
 }
+
+void RoutingProfiles::Save(serialization::SnapshotWriter& writer) const {
+  writer.WriteValue<uint64_t>(profiles_.size());
+  for (const auto& [name, profile] : profiles_) {
+    writer.WriteString(name);
+    WriteSettings(writer, profile->GetSettings());
+    profile->SaveProfile(writer);
+  }
+}
+
+void RoutingProfiles::AddProfile(std::string name, const RoutingSettings& settings) {
+  if (name.empty()) {
+    throw std::invalid_argument("Profile name can't be empty");
+  }
+  if (profiles_.count(name) > 0) {
+    throw std::invalid_argument("Profile " + name + " already exists");
+  }
+  profiles_.emplace(std::move(name), std::make_unique<TransportRouter>(router_, settings));
+}
+
+const TransportRouter* RoutingProfiles::GetProfile(std::string_view name) const {
+  if (name.empty()) {
+    return &router_;
+  }
+  const auto it = profiles_.find(name);
+  return it == profiles_.end() ? nullptr : it->second.get();
+}
+
+const TransportRouter& RoutingProfiles::GetMainProfile() const {
+  return router_;
+}
+
+const std::map<std::string, std::unique_ptr<TransportRouter>, std::less<>>& RoutingProfiles::GetProfiles() const {
+  return profiles_;
+}
+
 }
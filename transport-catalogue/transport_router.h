@@ -1,27 +1,62 @@
 #pragma once
 
+#include "astar_router.h"
+#include "contraction_hierarchy.h"
+#include "dijkstra_router.h"
 #include "domain.h"
 #include "graph.h"
+#include "query_context.h"
 #include "router.h"
 
 #include <chrono>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
-#include <unordered_map>
+#include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
 class TransportCatalogue;
 
+namespace serialization {
+class MappedFile;
+class SnapshotReader;
+class SnapshotWriter;
+}  // namespace serialization
+
 namespace tc::router {
 
+enum class RouterType {
+  ALL_PAIRS,              // Предподсчёт маршрутов между всеми парами вершин
+  DIJKSTRA,               // Поиск маршрута по запросу, без предподсчёта
+  CONTRACTION_HIERARCHY,  // Иерархия сжатия: быстрый запрос при линейной памяти
+  RAPTOR,                 // Поиск по раундам прямо по маршрутам автобусов, без графа
+  ASTAR,                  // Двунаправленный A* с оценкой по расстоянию между остановками
+};
+
+enum class GraphModel {
+  COMPLETE,  // Ребро для каждой пары остановок маршрута: O(n^2) рёбер на автобус
+  LINEAR,    // Вершина на каждую остановку маршрута: O(n) рёбер на автобус
+  SINGLE_VERTEX,  // Как COMPLETE, но одна вершина на остановку: ожидание входит в вес ребра автобуса
+};
+
 struct RoutingSettings {
   std::chrono::minutes bus_wait_time{};
   double bus_velocity = 0;
+  RouterType router_type = RouterType::ALL_PAIRS;
+  GraphModel graph_model = GraphModel::COMPLETE;
+  size_t router_threads = 1;  // 0 - по числу аппаратных потоков; больше их числа не запускается
+  bool prune_dominated_edges = false;  // Оставлять только самое дешёвое ребро между парой вершин
 };
 
 using Minutes = std::chrono::duration<double, std::chrono::minutes::period>;
 
+// Время поездки на автобусе на расстояние distance метров
+Minutes ComputeRideTime(const RoutingSettings& settings, size_t distance);
+
 struct RouteInfo {
   Minutes total_time;
 
@@ -40,6 +75,13 @@ struct RouteInfo {
   std::vector<Item> items;
 };
 
+struct ReachableStop {
+  const Stop *stop;
+  Minutes time{};
+};
+
+class RaptorRouter;
+
 class TransportRouter {
 public:
   struct StopVertexIds {
@@ -47,30 +89,175 @@ public:
     graph::VertexId out;
   };
 
+  // В модели LINEAR поездка состоит из нескольких рёбер подряд:
+  // посадки (span_count = 0) и перегонов (span_count = 1)
   struct BusEdge {
     const Bus *bus;
     size_t span_count;
+    // Длина поездки в метрах: по ней вес ребра пересчитывается при смене настроек
+    size_t distance = 0;
   };
 
   using EdgeInfo = std::optional<BusEdge>;
 
   TransportRouter() = default;
   TransportRouter(RoutingSettings settings, const TransportCatalogue& catalogue);
+  // Загрузка из снимка, записанного Save для того же справочника. Таблица маршрутизатора
+  // всех пар читается прямо из отображённого файла, остальные движки строятся заново
+  TransportRouter(const TransportCatalogue& catalogue, serialization::SnapshotReader& reader);
+  // Профиль: маршрутизатор с другими настройками на структуре графа base. Общие с base
+  // вершины, рёбра и их описания не копируются, свои у профиля только веса рёбер и движок.
+  // Модель графа и прореживание рёбер должны совпадать с base, иначе бросается std::logic_error
+  TransportRouter(const TransportRouter& base, const RoutingSettings& settings);
+  // Профиль из снимка, записанного SaveProfile: таблица маршрутизатора всех пар читается
+  // из отображённого файла, как у основного маршрутизатора
+  TransportRouter(const TransportRouter& base, const RoutingSettings& settings, serialization::SnapshotReader& reader);
+  ~TransportRouter();
+
+  void Save(serialization::SnapshotWriter& writer) const;
+  // Только то, что профиль не делит с base и что долго строить: таблицу маршрутизатора всех пар
+  void SaveProfile(serialization::SnapshotWriter& writer) const;
+
+  // Применяет новые bus_wait_time, bus_velocity и router_type: веса рёбер пересчитываются
+  // на месте, и заново строится только маршрутизатор. Модель графа и прореживание рёбер
+  // должны совпадать с прежними, иначе бросается std::logic_error
+  void ApplySettings(const RoutingSettings& settings);
+
+  // Буферы запросов маршрута, переиспользуемые от запроса к запросу
+  struct QueryContext {
+    graph::QueryContext<Minutes> search;
+    RouteInfo route;
+    // Для FindRoutes: маршруты по номеру остановки to, ответ и вершины to
+    std::vector<RouteInfo> routes;
+    std::vector<const RouteInfo*> found_routes;
+    std::vector<graph::VertexId> vertexes;
+  };
+
+  // Контекст текущего потока для FindRoute с контекстом
+  static QueryContext& GetThreadQueryContext();
 
   std::optional<RouteInfo> FindRoute(const Stop* from, const Stop* to) const;
+  // Маршрут строится в context.route; nullptr, если маршрута нет. Маршрутизаторы всех пар
+  // и Дейкстры, когда буферы контекста доросли, отвечают без выделения памяти.
+  // Остальные движки строят маршрут как FindRoute без контекста и копируют его в контекст
+  const RouteInfo* FindRoute(const Stop* from, const Stop* to, QueryContext& context) const;
+  // Маршруты из from во все остановки to, по порядку to; nullptr, если маршрута нет.
+  // Маршруты лежат в context и действительны до следующего запроса с ним. Дейкстра отвечает
+  // одним поиском из from, остальные движки - отдельным запросом на каждую пару.
+  // Память, как у FindRoute с контекстом, перестаёт выделяться, когда буферы доросли
+  const std::vector<const RouteInfo*>& FindRoutes(const Stop* from, const std::vector<const Stop*>& to,
+                                                  QueryContext& context) const;
+  // Матрица времени в пути from x to по строкам, без построения маршрутов.
+  // Строки считаются в router_threads потоков, по одному поиску на остановку from.
+  // Потоки каждый раз новые, а контексты поиска берутся из пула маршрутизатора
+  std::vector<std::optional<Minutes>> ComputeTravelTimes(const std::vector<const Stop*>& from,
+                                                         const std::vector<const Stop*>& to) const;
+  // Остановки, до которых из from можно доехать не дольше чем за max_time,
+  // по возрастанию времени (при равном времени - по названию)
+  std::vector<ReachableStop> FindReachableStops(const Stop* from, Minutes max_time) const;
 
+  const RoutingSettings& GetSettings() const;
   const graph::DirectedWeightedGraph<Minutes>& GetGraph() const;
+  // Сколько параллельных рёбер удалено при построении графа (prune_dominated_edges)
+  size_t GetPrunedEdgeCount() const;
 
 private:
+  // reader - снимок, из которого читается таблица профиля, или nullptr
+  TransportRouter(const TransportRouter& base, const RoutingSettings& settings, serialization::SnapshotReader* reader);
+
+  // Всё, что не зависит от весов рёбер, и поэтому общее у всех профилей
+  struct Topology {
+    std::vector<StopVertexIds> stops_vertex_ids;  // По номеру остановки
+    std::vector<const Stop*> vertexes;
+    std::vector<EdgeInfo> edges;
+    // Наименьшее отношение дорожного расстояния между соседними остановками маршрутов
+    // к расстоянию между ними по прямой (хорде), но не больше 1. Хорда, умноженная
+    // на него, - нижняя оценка длины пути по дорогам для A*
+    double road_to_chord_ratio = 1.0;
+    size_t pruned_edge_count = 0;
+  };
+
+  // Бросает std::logic_error, если settings требуют другой структуры графа
+  void CheckSameTopology(const RoutingSettings& settings) const;
+  // Пересчитывает веса рёбер по settings_
+  void UpdateEdgeWeights();
+  // Заполняет route_info заново, сохраняя выделенную под items память
+  void FillRouteInfo(Minutes total_time, const std::vector<graph::EdgeId>& edges, RouteInfo& route_info) const;
+  // Вес ребра по текущим настройкам: ожидание для рёбер ожидания, время поездки для рёбер автобусов
+  Minutes ComputeEdgeWeight(const EdgeInfo& edge_info) const;
+  void AddEdge(graph::VertexId from, graph::VertexId to, EdgeInfo edge_info);
+
   void AddStopsToGraph(const TransportCatalogue& catalogue);
   void AddBusesToGraph(const TransportCatalogue& catalogue);
+  void AddCompleteBusToGraph(const TransportCatalogue& catalogue, const Bus& bus);
+  void AddLinearBusToGraph(const TransportCatalogue& catalogue, const Bus& bus);
+  size_t CountVertices(const TransportCatalogue& catalogue) const;
+  // Из параллельных рёбер оставляет самое дешёвое, при равном весе - с меньшими
+  // названием автобуса и числом пролётов. Возвращает число удалённых рёбер
+  size_t PruneDominatedEdges();
+  bool IsBetterEdge(graph::EdgeId lhs, graph::EdgeId rhs) const;
+  // Переводит граф в CSR и переставляет edges_ под новые идентификаторы рёбер
+  void FreezeGraph();
+  void BuildRouter();
+  // Таблица маршрутизатора всех пар, если router_ - он. Загрузка строит router_ поверх
+  // таблицы из файла, а без таблицы - заново через BuildRouter
+  void SaveRoutesTable(serialization::SnapshotWriter& writer) const;
+  void LoadRoutesTable(serialization::SnapshotReader& reader);
+  // Строит search_router_, если router_ сам не Дейкстра
+  void BuildSearchRouter();
+  // Дейкстра для поисков по графу в обход router_: router_ или search_router_
+  const graph::DijkstraRouter<Minutes>& GetSearchRouter() const;
+  size_t GetRouterThreadCount() const;
+  // Контекст поиска из пула, иначе новый. Release возвращает его в пул
+  std::unique_ptr<graph::QueryContext<Minutes>> AcquireSearchContext() const;
+  void ReleaseSearchContext(std::unique_ptr<graph::QueryContext<Minutes>> context) const;
+  std::vector<graph::AStarRouter<Minutes>::Point> ComputeVertexPoints() const;
+
+  using GraphRouter = std::variant<
+    std::unique_ptr<graph::Router<Minutes>>,
+    std::unique_ptr<graph::DijkstraRouter<Minutes>>,
+    std::unique_ptr<graph::ContractionHierarchy<Minutes>>,
+    std::unique_ptr<graph::AStarRouter<Minutes>>>;
 
   RoutingSettings settings_;
   graph::DirectedWeightedGraph<Minutes> graph_;
-  std::unique_ptr<graph::Router<Minutes>> router_;
-  std::unordered_map<const Stop*, StopVertexIds, Hasher> stops_vertex_ids_;
-  std::vector<const Stop*> vertexes_;
-  std::vector<EdgeInfo> edges_;
+  // Файл снимка, в который смотрит таблица router_, должен её пережить
+  std::shared_ptr<const serialization::MappedFile> snapshot_file_;
+  GraphRouter router_;
+  std::unique_ptr<graph::DijkstraRouter<Minutes>> search_router_;
+  std::unique_ptr<RaptorRouter> raptor_router_;
+  // Свободные контексты поиска для потоков ComputeTravelTimes
+  mutable std::mutex search_contexts_mutex_;
+  mutable std::vector<std::unique_ptr<graph::QueryContext<Minutes>>> search_contexts_;
+  std::shared_ptr<Topology> topology_ = std::make_shared<Topology>();
+  graph::VertexId next_vertex_id_ = 0;
+};
+
+// Маршрутизаторы по именованным профилям настроек на общей структуре графа.
+// Основной профиль - с пустым именем
+class RoutingProfiles {
+public:
+  explicit RoutingProfiles(const TransportRouter& router);
+  // Загрузка профилей, записанных Save, поверх основного маршрутизатора из того же снимка
+  RoutingProfiles(const TransportRouter& router, serialization::SnapshotReader& reader);
+
+  // Пишутся имена, настройки и таблицы маршрутизаторов всех пар: при загрузке
+  // заново строятся только остальные движки профилей
+  void Save(serialization::SnapshotWriter& writer) const;
+
+  // Бросает std::logic_error, как конструктор профиля TransportRouter, и std::invalid_argument,
+  // если профиль с таким именем уже есть
+  void AddProfile(std::string name, const RoutingSettings& settings);
+  // nullptr, если профиля нет
+  const TransportRouter* GetProfile(std::string_view name) const;
+
+  const TransportRouter& GetMainProfile() const;
+  // Дополнительные профили по имени
+  const std::map<std::string, std::unique_ptr<TransportRouter>, std::less<>>& GetProfiles() const;
+
+private:
+  const TransportRouter& router_;
+  std::map<std::string, std::unique_ptr<TransportRouter>, std::less<>> profiles_;
 };
 
 }  // namespace tc::router